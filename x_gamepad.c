@@ -30,6 +30,8 @@
 #define VERSION "UNDEFINED"
 #endif
 
+#include <stdint.h>
+
 #if APL
 #include <pthread.h>
 #include <ApplicationServices/ApplicationServices.h>
@@ -49,8 +51,18 @@
 #endif
 
 #if LIN
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <time.h>
 #include <GL/gl.h>
 #include <X11/keysym.h>
 #include <X11/extensions/XTest.h>
@@ -58,19 +70,41 @@
 #include "hidapi.h"
 #endif
 
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define USE_SSE 1
+#else
+#define USE_SSE 0
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define USE_SSE2 1
+#else
+#define USE_SSE2 0
+#endif
+
 #define NAME "X-Gamepad"
 #define NAME_LOWERCASE "x_gamepad"
 
 #if IBM
 #define CONFIG_PATH ".\\Resources\\plugins\\" NAME_LOWERCASE "\\" NAME_LOWERCASE ".prf"
+#define CALIBRATION_PATH ".\\Resources\\plugins\\" NAME_LOWERCASE "\\" NAME_LOWERCASE ".cal"
 #else
 #define CONFIG_PATH "./Resources/plugins/" NAME_LOWERCASE "/" NAME_LOWERCASE ".prf"
+#define CALIBRATION_PATH "./Resources/plugins/" NAME_LOWERCASE "/" NAME_LOWERCASE ".cal"
 #endif
 
+// must be incremented whenever the layout of the settings struct changes
+#define SETTINGS_VERSION 2
+
 #define JOYSTICK_AXIS_ABSTRACT_LEFT_X 0
 #define JOYSTICK_AXIS_ABSTRACT_LEFT_Y 1
 #define JOYSTICK_AXIS_ABSTRACT_RIGHT_X 2
 #define JOYSTICK_AXIS_ABSTRACT_RIGHT_Y 3
+#define JOYSTICK_AXIS_ABSTRACT_LEFT_TRIGGER 4
+#define JOYSTICK_AXIS_ABSTRACT_RIGHT_TRIGGER 5
+#define NUM_ABSTRACT_AXES 6
 
 #if IBM
 #define JOYSTICK_AXIS_XBOX360_LEFT_X 1
@@ -308,11 +342,44 @@
 
 #define BUTTON_LONG_PRESS_TIME 1.0f
 
-#define JOYSTICK_RELATIVE_CONTROL_EXPONENT 3.0
 #define JOYSTICK_RELATIVE_CONTROL_MULTIPLIER 2.0f
+#define INTEGRATION_TIMESTEP (1.0f / 250.0f)
+#define MAX_INTEGRATION_CATCH_UP 0.1f
+
+#define ONE_EURO_FILTER_TWO_PI 6.2831853f
+
+#define MAX_CALIBRATED_DEVICES 8
+#define CALIBRATION_REST_TOLERANCE 0.01f
+#define CALIBRATION_REST_DURATION 2.0f
+#define CALIBRATION_MAX_CENTER_OFFSET 0.03f
+#define CALIBRATION_MIN_EXTENT 0.4f
+
+#define RESPONSE_CURVE_TABLE_SIZE 256
+#define MAX_RESPONSE_CURVE_POINTS 8
+#define MAX_CURVE_POINTS_TEXT_LENGTH 128
 
 #define JOYSTICK_LOOK_SENSITIVITY 225.0f
 #define JOYSTICK_MOUSE_POINTER_SENSITIVITY 30.0f
+#define TRIGGER_THRESHOLD (30.0f / 255.0f)
+
+#define PLUGIN_CHECK_INTERVAL 5.0f
+#define MAX_MODE_OVERLAY_RETRIES 100
+
+#define MAX_ACTIVE_COMMANDS 64
+
+#define IDLE_FLIGHT_LOOP_INTERVAL 0.05f
+// negative intervals count flight loops, so the first input after idling is picked up no later than one frame after it arrives
+#define IDLE_INPUT_FLIGHT_LOOP_INTERVAL -2.0f
+
+#define MAX_OVERLAY_ENTRIES 24
+#define MAX_MODE_LAYERS 8
+#define MAX_AXIS_BINDINGS 16
+#define MAX_DISPATCH_BUTTONS 64
+#define NUM_JOYSTICK_BUTTONS 1600
+#define BUTTON_BITSET_WORDS ((NUM_JOYSTICK_BUTTONS + 63) / 64)
+
+#define WRITE_CACHE_SIZE 64
+#define WRITE_CACHE_EPSILON 0.000001f
 
 #define INDICATOR_LEVER_WIDTH 20
 #define INDICATOR_LEVER_HEIGHT 144
@@ -329,6 +396,13 @@
 #define TOUCHPAD_CURSOR_SENSITIVITY 1.0f
 #define TOUCHPAD_SCROLL_SENSITIVITY 0.1f
 
+#if LIN
+#define EVDEV_DIRECTORY "/dev/input"
+#define EVDEV_ENUMERATION_INTERVAL 5.0f
+#define MIN_INPUT_THREAD_RATE 250
+#define MAX_INPUT_THREAD_RATE 1000
+#endif
+
 #define INDICATORS_FRAGMENT_SHADER "#version 130\n"                                                                                                                                                                                                                                                                                                                    \
                                    ""                                                                                                                                                                                                                                                                                                                                  \
                                    "uniform ivec2 size;"                                                                                                                                                                                                                                                                                                               \
@@ -645,7 +719,8 @@ typedef enum
     TRIM,
     SPEEDBRAKE,
     MOUSE,
-    KEYBOARD
+    KEYBOARD,
+    NUM_MODES
 } Mode;
 
 typedef enum
@@ -696,8 +771,80 @@ typedef struct KeyboardKey
     struct KeyboardKey *right;
 } KeyboardKey;
 
+typedef enum
+{
+    CURVE_LINEAR,
+    CURVE_QUADRATIC,
+    CURVE_CUBIC,
+    CURVE_S,
+    CURVE_CUSTOM,
+    NUM_CURVE_TYPES
+} CurveType;
+
+typedef struct
+{
+    CurveType type;
+    int numPoints;
+    float points[MAX_RESPONSE_CURVE_POINTS][2];
+} CurveConfig;
+
+typedef enum
+{
+    DEADZONE_AXIAL,
+    DEADZONE_RADIAL
+} DeadzoneType;
+
+typedef struct
+{
+    DeadzoneType type;
+    float inner;
+    float outer;
+    float antiDeadzone;
+} DeadzoneConfig;
+
 typedef struct
 {
+    int enabled;
+    float minCutoff;
+    float beta;
+    float derivativeCutoff;
+} FilterConfig;
+
+typedef enum
+{
+    ACTUATOR_POWER,
+    ACTUATOR_THROTTLE,
+    ACTUATOR_COLLECTIVE,
+    ACTUATOR_SPEEDBRAKE,
+    ACTUATOR_PROP,
+    ACTUATOR_MIXTURE,
+    ACTUATOR_COWL_FLAPS,
+    NUM_ACTUATORS
+} Actuator;
+
+typedef enum
+{
+    BOUNDS_ACTUATOR,
+    BOUNDS_CUSTOM
+} BoundsSource;
+
+typedef struct
+{
+    int axis;
+    Mode mode;
+    Actuator actuator;
+    // index of the axis curve that shapes the deflection, by default the curve of the bound axis itself
+    int curve;
+    float rate;
+    // custom bounds are ratios of the range of the actuator
+    BoundsSource boundsSource;
+    float minimum;
+    float maximum;
+} AxisBinding;
+
+typedef struct
+{
+    int version;
     ControllerType controllerType;
     int axisOffset;
     int buttonOffset;
@@ -707,31 +854,313 @@ typedef struct
     int indicatorsBottom;
     int keyboardRight;
     int keyboardBottom;
+    CurveConfig axisCurves[NUM_ABSTRACT_AXES];
+    DeadzoneConfig stickDeadzones[2];
+    FilterConfig axisFilters[4];
+    AxisBinding axisBindings[MAX_AXIS_BINDINGS];
+    int numAxisBindings;
+    int directInput;
+    int inputThreadRate;
+    int directButtonDispatch;
 } Settings;
 
+typedef enum
+{
+    COMMAND_GENERAL_LEFT,
+    COMMAND_GENERAL_RIGHT,
+    COMMAND_GENERAL_UP,
+    COMMAND_GENERAL_DOWN,
+    COMMAND_GENERAL_ROT_LEFT,
+    COMMAND_GENERAL_ROT_RIGHT,
+    COMMAND_GENERAL_FORWARD,
+    COMMAND_GENERAL_BACKWARD,
+    COMMAND_GENERAL_ZOOM_IN,
+    COMMAND_GENERAL_ZOOM_OUT,
+    COMMAND_VIEW_3D_COCKPIT_COMMAND_LOOK,
+    COMMAND_VIEW_FORWARD_WITH_2D_PANEL,
+    COMMAND_VIEW_FORWARD_WITH_HUD,
+    COMMAND_VIEW_CHASE,
+    COMMAND_VIEW_CIRCLE,
+    COMMAND_AUTOPILOT_SERVOS_OFF_ANY,
+    COMMAND_AUTOPILOT_CONTROL_WHEEL_STEER,
+    COMMAND_AUTOPILOT_FLIGHT_DIR_DOWN,
+    COMMAND_FLIGHT_CONTROLS_AILERON_TRIM_LEFT,
+    COMMAND_FLIGHT_CONTROLS_AILERON_TRIM_RIGHT,
+    COMMAND_FLIGHT_CONTROLS_AILERON_TRIM_CENTER,
+    COMMAND_FLIGHT_CONTROLS_RUDDER_TRIM_LEFT,
+    COMMAND_FLIGHT_CONTROLS_RUDDER_TRIM_RIGHT,
+    COMMAND_FLIGHT_CONTROLS_RUDDER_TRIM_CENTER,
+    COMMAND_FLIGHT_CONTROLS_PITCH_TRIM_UP,
+    COMMAND_FLIGHT_CONTROLS_PITCH_TRIM_DOWN,
+    COMMAND_FLIGHT_CONTROLS_FLAPS_UP,
+    COMMAND_FLIGHT_CONTROLS_FLAPS_DOWN,
+    COMMAND_FLIGHT_CONTROLS_LANDING_GEAR_TOGGLE,
+    COMMAND_FLIGHT_CONTROLS_BRAKES_TOGGLE_MAX,
+    COMMAND_FLIGHT_CONTROLS_SPEED_BRAKES_UP_ONE,
+    COMMAND_FLIGHT_CONTROLS_SPEED_BRAKES_DOWN_ONE,
+    COMMAND_ENGINES_CARB_HEAT_TOGGLE,
+    COMMAND_NONE,
+    COMMAND_AS350_FORCE_TRIM,
+    COMMAND_AS350_TRIM_RELEASE,
+    COMMAND_B407_FORCE_TRIM,
+    COMMAND_B407_TRIM_RELEASE,
+    COMMAND_EC135_BEEP_LEFT,
+    COMMAND_EC135_BEEP_RIGHT,
+    COMMAND_EC135_BEEP_FWD,
+    COMMAND_EC135_BEEP_AFT,
+    COMMAND_B738_CAPT_DISCO_PRESS,
+    COMMAND_HEAD_SHAKE_STOP,
+    NUM_COMMANDS
+} CommandId;
+
+typedef enum
+{
+    PLUGIN_DREAMFOIL_AS350,
+    PLUGIN_DREAMFOIL_B407,
+    PLUGIN_HEAD_SHAKE,
+    PLUGIN_ROTORSIM_EC135,
+    PLUGIN_X_IVAP,
+    PLUGIN_X_XSQUAWKBOX,
+    PLUGIN_TOLISS,
+    PLUGIN_ZIBO,
+    NUM_PLUGINS
+} PluginId;
+
+typedef enum
+{
+    THIRD_PARTY_DATAREF_AIRBUS_THROTTLE_INPUT,
+    NUM_THIRD_PARTY_DATAREFS
+} ThirdPartyDataRefId;
+
+typedef struct
+{
+    int numEngines;
+    int helicopter;
+    int gliderWithSpeedbrakes;
+    int hasSpeedbrake;
+    int hasBeta;
+    int hasReverser;
+    int has2DPanel;
+    int enType[8];
+    int propType[8];
+    float minPitch[8];
+    float maxPitch[8];
+    float rscRedlinePrp;
+    float featheredPitch;
+    int numPropLevers;
+    int numMixtureLevers;
+    XPLMDataRef throttleRatioDataRef;
+} AircraftProfile;
+
+typedef struct
+{
+    XPLMDataRef dataRef;
+    int index;
+    int cycleNumber;
+    float value;
+} CachedWrite;
+
+typedef struct
+{
+    ControllerType controllerType;
+    int axisOffset;
+    int axisStart;
+    int axisCount;
+} ReadPlan;
+
+typedef struct
+{
+    int cycleNumber;
+    int hasJoystick;
+    int viewType;
+    int paused;
+    float joystickPitchNullzone;
+} FrameState;
+
+typedef struct
+{
+    float throttle;
+    float prop;
+    float mixture;
+} IndicatorValues;
+
+typedef struct
+{
+    int valid;
+    CurveConfig config;
+    float table[RESPONSE_CURVE_TABLE_SIZE + 1];
+} ResponseCurve;
+
+typedef struct
+{
+    float deflections[NUM_ABSTRACT_AXES];
+    float values[NUM_ABSTRACT_AXES];
+} ConditionedAxes;
+
+typedef struct
+{
+    int index;
+    int assignment;
+} AssignmentOverlayEntry;
+
+typedef struct
+{
+    int numEntries;
+    AssignmentOverlayEntry entries[MAX_OVERLAY_ENTRIES];
+} AssignmentOverlay;
+
+typedef enum
+{
+    AXIS_OVERLAY,
+    BUTTON_OVERLAY,
+    NUM_OVERLAY_TYPES
+} OverlayType;
+
+typedef struct
+{
+    Mode mode;
+    AssignmentOverlay previousOverlays[NUM_OVERLAY_TYPES];
+} ModeLayer;
+
+typedef struct
+{
+    ControllerType controllerType;
+    int axisOffset;
+    int buttonOffset;
+    unsigned int enabledPlugins;
+    XPLMCommandRef forceTrimCommand;
+    AssignmentOverlay axisOverlays[NUM_MODES];
+    AssignmentOverlay buttonOverlays[NUM_MODES];
+    int buttonWindowStart;
+    int buttonWindowCount;
+} ModeOverlayTable;
+
+#if LIN
+typedef enum
+{
+    CONTROLLER_AXIS_LEFT_X,
+    CONTROLLER_AXIS_LEFT_Y,
+    CONTROLLER_AXIS_RIGHT_X,
+    CONTROLLER_AXIS_RIGHT_Y,
+    CONTROLLER_AXIS_LEFT_TRIGGER,
+    CONTROLLER_AXIS_RIGHT_TRIGGER,
+    NUM_CONTROLLER_AXES
+} ControllerAxis;
+
+typedef struct
+{
+    float axisValues[NUM_CONTROLLER_AXES];
+    unsigned int buttons;
+    unsigned int pressedButtons;
+    unsigned int releasedButtons;
+} ControllerState;
+
+typedef struct
+{
+    int rate;
+    FilterConfig axisFilters[4];
+} InputThreadConfig;
+#endif
+
+typedef void (*ActuatorHandler)(float deflection, float sensitivityMultiplier, float minimum, float maximum);
+
+typedef struct
+{
+    ActuatorHandler handler;
+    const ResponseCurve *responseCurve;
+    float rate;
+    float minimum;
+    float maximum;
+} CompiledAxisBinding;
+
+typedef struct
+{
+    int initialized;
+    float value;
+    float derivative;
+} OneEuroFilter;
+
+typedef struct
+{
+    float center;
+    float minimum;
+    float maximum;
+} AxisCalibration;
+
+typedef struct
+{
+    ControllerType controllerType;
+    int axisOffset;
+    AxisCalibration axes[4];
+} DeviceCalibration;
+
+typedef struct
+{
+    int live;
+    float restAnchor;
+    float restSum;
+    int restSamples;
+    float restTime;
+} AxisCalibrationState;
+
+#if LIN
+static const ControllerState *AcquireControllerState(void);
+#endif
+static void ActuateCollective(float deflection, float sensitivityMultiplier, float minimum, float maximum);
+static void ActuateCowlFlaps(float deflection, float sensitivityMultiplier, float minimum, float maximum);
+static void ActuateMixture(float deflection, float sensitivityMultiplier, float minimum, float maximum);
+static void ActuateProp(float deflection, float sensitivityMultiplier, float minimum, float maximum);
+static void ActuateSpeedbrake(float deflection, float sensitivityMultiplier, float minimum, float maximum);
+static void ActuateThrottle(float deflection, float sensitivityMultiplier, float minimum, float maximum);
+static void AddAxisOverlayEntry(AssignmentOverlay *axisOverlay, int index, int assignment);
+static void AddButtonOverlayEntry(AssignmentOverlay *buttonOverlay, int index, XPLMCommandRef command);
+static void AddOverlayEntry(AssignmentOverlay *overlay, int index, int assignment);
+static float AdvanceIntegrationClock(float elapsedTime);
+static void ApplyAxisOverlay(const AssignmentOverlay *axisOverlay, AssignmentOverlay *previousAxisOverlay);
+static void ApplyButtonOverlay(const AssignmentOverlay *buttonOverlay, AssignmentOverlay *previousButtonOverlay);
+static float ApplyOneEuroFilter(OneEuroFilter *filter, const FilterConfig *filterConfig, float value, float elapsedTime);
 static int AxisIndex(int abstractAxisIndex);
+static int AxisSettingsWidgetHandler(XPWidgetMessage inMessage, XPWidgetID inWidget, intptr_t inParam1, intptr_t inParam2);
+static void BeginCommand(XPLMCommandRef command);
 static int ButtonIndex(int abstractButtonIndex);
+static int CalibrateAxes(float *joystickAxisValues, float nullzone, float elapsedTime);
+static int CanPushModeLayer(Mode m);
+static void ClaimDispatchButtons(void);
 #if !LIN
 static void CleanupDeviceThread(hid_device *handle, struct hid_device_info *dev);
 #endif
 static void CleanupShader(GLuint program, GLuint fragmentShader, int deleteProgram);
+static void ClearWriteCache(void);
+static void CompileAxisBindings(void);
+static void ConditionAxes(const float *joystickAxisValues, const float *triggerValues, float nullzone, float elapsedTime, int filtered, ConditionedAxes *conditionedAxes);
+inline static int CountTrailingZeros(uint64_t bits);
 static int CowlFlapModifierCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
+static XPWidgetID CreateSlider(int left, int top, int right, int bottom, int min, int max);
+static float CurveValue(const CurveConfig *curveConfig, float x);
 static int CwsOrDisconnectAutopilotCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 #if IBM
 static void DeviceThread(void *argument);
 #elif APL
 static void *DeviceThread(void *argument);
 #endif
+static int DispatchButtons(void);
 static void DrawIndicatorsWindow(XPLMWindowID inWindowID, void *inRefcon);
 static void DrawKeyboardWindow(XPLMWindowID inWindowID, void *inRefcon);
+static void EndCommand(XPLMCommandRef command);
 static void EndKeyboardMode(void);
-static float Exponentialize(float value, float inMin, float inMax, float outMin, float outMax);
+inline static float EvaluateResponseCurve(const ResponseCurve *responseCurve, float x);
+static int FindActiveCommand(XPLMCommandRef command);
+static AxisBinding *FindAxisBinding(Mode m, int abstractAxisIndex);
+static int FindModeLayer(Mode m);
+static AssignmentOverlayEntry *FindOverlayEntry(AssignmentOverlay *overlay, int index);
 static void FitGeometryWithinScreenBounds(int *left, int *top, int *right, int *bottom);
-static float FlightLoopCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon);
 inline static int FloatsEqual(float a, float b);
+static void FormatCurvePoints(const CurveConfig *curveConfig, char *text, size_t size);
+static XPLMCommandRef GetCommand(CommandId commandId);
+static int GetDefaultAxisAssignment(int abstractAxisIndex);
+static DeviceCalibration *GetDeviceCalibration(void);
 inline static int GetKeyboardWidth(void);
 static float GetThrottleRatio(XPLMDataRef fallbackThrottleRatioDataRef);
-static XPLMDataRef GetThrottleRatioDataRef(void);
 static XPLMCursorStatus HandleCursor(XPLMWindowID inWindowID, int x, int y, void *inRefcon);
 static void HandleKey(XPLMWindowID inWindowID, char inKeyboardKey, XPLMKeyFlags inFlags, char inVirtualKeyboardKey, void *inRefcon, int losingFocus);
 static void HandleKeyboardSelectorCommand(XPLMCommandPhase inPhase, KeyboardKey *newSelectedKeyboardKey);
@@ -740,16 +1169,22 @@ static int HandleMouseWheel(XPLMWindowID inWindowID, int x, int y, int wheel, in
 static void HandleScrollCommand(XPLMCommandPhase phase, int clicks);
 static void HandleToggleMouseButtonCommand(XPLMCommandPhase phase, MouseButton button);
 static int Has2DPanel(void);
+static float HousekeepingFlightLoopCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon);
 static KeyboardKey InitKeyboardKey(const char *label, int keyCode, float aspect, KeyPosition position);
 static void InitShader(const char *fragmentShaderString, GLuint *program, GLuint *fragmentShader);
-inline static int IsGliderWithSpeedbrakes(void);
-static int IsHelicopter(void);
+static float InputFlightLoopCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon);
+#if LIN
+static void *InputThread(void *argument);
+#endif
+inline static int IntegrateDeflection(float deflection, float rate, float min, float max, float *value);
 inline static int IsLockKey(KeyboardKey keyboardKey);
-static int IsPluginEnabled(const char *pluginSignature);
+inline static int IsModeActive(Mode m);
+inline static int IsPluginEnabled(PluginId pluginId);
 static int KeyboardSelectorDownCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 static int KeyboardSelectorLeftCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 static int KeyboardSelectorRightCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 static int KeyboardSelectorUpCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
+static void LoadCalibration(void);
 static int LockKeyboardKeyCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 static int LookModifierCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 static void MakeInput(int keyCode, KeyState state);
@@ -757,22 +1192,40 @@ static void MenuHandlerCallback(void *inMenuRef, void *inItemRef);
 static int MixtureControlModifierCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 static void MoveMousePointer(int distX, int distY, void *display);
 static float Normalize(float value, float inMin, float inMax, float outMin, float outMax);
+#if LIN
+static int OpenEvdevDevice(void);
+#endif
 static void OverrideCameraControls(void);
-static void PopButtonAssignments(void);
+static void PackButtonValues(const int *buttonValues, int numButtons, uint64_t *buttonBits);
+static int ParseCurvePoints(const char *text, CurveConfig *curveConfig);
+static int PopModeLayer(Mode m);
 static int PressKeyboardKeyCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 static int PropPitchOrThrottleModifierCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
-static void PushButtonAssignments(void);
+#if LIN
+static void PublishControllerState(const ControllerState *state);
+#endif
+static void PushModeLayer(Mode m);
 static int PushToTalkCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
+static void RecompileAxisBindings(Mode m, int abstractAxisIndex);
 static void ReleaseAllKeys(void);
+static void ReleaseDispatchedButtons(void);
 static int ResetSwitchViewCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
+static XPLMCommandRef ResolveButtonCommand(int index);
+static void ResolveCommands(void);
+static void ResolveThirdPartyDataRefs(void);
 static void RestoreCameraControls(void);
+static void SaveCalibration(void);
 static void SaveSettings(void);
 static void Scroll(int clicks, void *display);
 static int ScrollDownCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 static int ScrollUpCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
+static void SetDatafCached(XPLMDataRef dataRef, float value);
+static void SetDatavfCached(XPLMDataRef dataRef, float *values, int offset, int count);
 static void SetDefaultAssignments(void);
 static void SetToLissThrottle(float throttleRatio);
 static int SettingsWidgetHandler(XPWidgetMessage inMessage, XPWidgetID inWidget, intptr_t inParam1, intptr_t inParam2);
+static void ShowAxisSettingsWidget(void);
+inline static float SmoothingFactor(float cutoff, float elapsedTime);
 static int SpeedbrakeModifierOrToggleCarbHeatCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 static void StopConfiguration(void);
 inline static void SyncLockKeyState(KeyboardKey *keyboardKey);
@@ -784,11 +1237,29 @@ static int ToggleMouseOrKeyboardControlCommand(XPLMCommandRef inCommand, XPLMCom
 static int ToggleLeftMouseButtonCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 static int ToggleReverseCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 static int ToggleRightMouseButtonCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
+static void TrackCommandPhase(XPLMCommandRef command, XPLMCommandPhase phase);
 static int TrimModifierCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 static int TrimResetCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
+static void UnclaimDispatchButtons(void);
+static void UpdateAircraftProfile(void);
+inline static int UpdateAxisLiveness(AxisCalibrationState *state, float value);
+static void UpdateAxisSettingsWidgets(void);
+static void UpdateButtonDispatch(void);
+static void UpdateEnabledPlugins(void);
+static void UpdateFrameState(void);
+static void UpdateIndicatorValues(void);
 static void UpdateIndicatorsWindow(int vrEnabled);
+#if LIN
+static void UpdateInputThreadConfig(void);
+#endif
+static void UpdateModeOverlays(void);
+static void UpdateReadPlan(void);
+static void UpdateResponseCurve(ResponseCurve *responseCurve, const CurveConfig *curveConfig);
 static void UpdateSettingsWidgets(void);
 inline static void UpdateToeBrakeControl(void);
+static int UpdateTriggers(float leftTrigger, float rightTrigger);
+static int UpdateWriteCache(XPLMDataRef dataRef, int index, int array, float value);
+static void WakeFlightLoop(void);
 inline static void WireKey(KeyboardKey *keyboardKey, KeyboardKey *left, KeyboardKey *right, KeyboardKey *above, KeyboardKey *below);
 static void WireKeys(void);
 
@@ -796,14 +1267,42 @@ static KeyboardKey escapeKeyboardKey, f1KeyboardKey, f2KeyboardKey, f3KeyboardKe
 static KeyboardKey *keyboardKeys[] = {&escapeKeyboardKey, &f1KeyboardKey, &f2KeyboardKey, &f3KeyboardKey, &f4KeyboardKey, &f5KeyboardKey, &f6KeyboardKey, &f7KeyboardKey, &f8KeyboardKey, &f9KeyboardKey, &f10KeyboardKey, &f11KeyboardKey, &f12KeyboardKey, &sysRqKeyboardKey, &scrollKeyboardKey, &pauseKeyboardKey, &insertKeyboardKey, &deleteKeyboardKey, &homeKeyboardKey, &endKeyboardKey, &graveKeyboardKey, &d1KeyboardKey, &d2KeyboardKey, &d3KeyboardKey, &d4KeyboardKey, &d5KeyboardKey, &d6KeyboardKey, &d7KeyboardKey, &d8KeyboardKey, &d9KeyboardKey, &d0KeyboardKey, &minusKeyboardKey, &equalsKeyboardKey, &backKeyboardKey, &numLockKeyboardKey, &divideKeyboardKey, &multiplyKeyboardKey, &subtractKeyboardKey, &tabKeyboardKey, &qKeyboardKey, &wKeyboardKey, &eKeyboardKey, &rKeyboardKey, &tKeyboardKey, &yKeyboardKey, &uKeyboardKey, &iKeyboardKey, &oKeyboardKey, &pKeyboardKey, &leftBracketKeyboardKey, &rightBracketKeyboardKey, &backslashKeyboardKey, &numpad7KeyboardKey, &numpad8KeyboardKey, &numpad9KeyboardKey, &addKeyboardKey, &captialKeyboardKey, &aKeyboardKey, &sKeyboardKey, &dKeyboardKey, &fKeyboardKey, &gKeyboardKey, &hKeyboardKey, &jKeyboardKey, &kKeyboardKey, &lKeyboardKey, &semicolonKeyboardKey, &apostropheKeyboardKey, &returnKeyboardKey, &numpad4KeyboardKey, &numpad5KeyboardKey, &numpad6KeyboardKey, &pageUpKeyboardKey, &leftShiftKeyboardKey, &zKeyboardKey, &xKeyboardKey, &cKeyboardKey, &vKeyboardKey, &bKeyboardKey, &nKeyboardKey, &mKeyboardKey, &commaKeyboardKey, &periodKeyboardKey, &slashKeyboardKey, &rightShiftKeyboardKey, &numpad1KeyboardKey, &numpad2KeyboardKey, &numpad3KeyboardKey, &pageDownKeyboardKey, &leftControlKeyboardKey, &leftWindowsKeyboardKey, &leftAltKeyboardKey, &spaceKeyboardKey, &rightAltKeyboardKey, &rightWindowsKeyboardKey, &appsKeyboardKey, &rightControlKeyboardKey, &upKeyboardKey, &downKeyboardKey, &leftKeyboardKey, &rightKeyboardKey, &numpad0KeyboardKey, &numpadCommaKeyboardKey, &numpadEnterKeyboardKey};
 static KeyboardKey *selectedKey = &kKeyboardKey;
 
-static int numMixtureLevers = 0, numPropLevers = 0, keyPressActive = 0, lastCinemaVerite = 0, thrustReverserMode = 0, switchTo3DCommandLook = 0;
+static int keyPressActive = 0, lastCinemaVerite = 0, thrustReverserMode = 0, switchTo3DCommandLook = 0;
 static float defaultHeadPositionX = FLT_MAX, defaultHeadPositionY = FLT_MAX, defaultHeadPositionZ = FLT_MAX;
-static Settings settings = {XBOX360, 0, 0, 0, 1, 0, 0, 0, 0};
-static Mode mode = DEFAULT;
+static Settings settings = {SETTINGS_VERSION, XBOX360, 0, 0, 0, 1, 0, 0, 0, 0, {{CURVE_CUBIC, 0, {{0.0f}}}, {CURVE_CUBIC, 0, {{0.0f}}}, {CURVE_CUBIC, 0, {{0.0f}}}, {CURVE_CUBIC, 0, {{0.0f}}}, {CURVE_LINEAR, 0, {{0.0f}}}, {CURVE_LINEAR, 0, {{0.0f}}}}, {{DEADZONE_AXIAL, -1.0f, 1.0f, -1.0f}, {DEADZONE_AXIAL, -1.0f, 1.0f, -1.0f}}, {{0, 1.5f, 2.0f, 1.0f}, {0, 1.5f, 2.0f, 1.0f}, {0, 1.5f, 2.0f, 1.0f}, {0, 1.5f, 2.0f, 1.0f}}, {{JOYSTICK_AXIS_ABSTRACT_LEFT_Y, DEFAULT, ACTUATOR_POWER, JOYSTICK_AXIS_ABSTRACT_LEFT_Y, -1.0f, BOUNDS_ACTUATOR, 0.0f, 1.0f}, {JOYSTICK_AXIS_ABSTRACT_LEFT_Y, SWITCH_VIEW, ACTUATOR_POWER, JOYSTICK_AXIS_ABSTRACT_LEFT_Y, -1.0f, BOUNDS_ACTUATOR, 0.0f, 1.0f}, {JOYSTICK_AXIS_ABSTRACT_LEFT_Y, PROP, ACTUATOR_PROP, JOYSTICK_AXIS_ABSTRACT_LEFT_Y, -1.0f, BOUNDS_ACTUATOR, 0.0f, 1.0f}, {JOYSTICK_AXIS_ABSTRACT_LEFT_Y, MIXTURE, ACTUATOR_MIXTURE, JOYSTICK_AXIS_ABSTRACT_LEFT_Y, -1.0f, BOUNDS_ACTUATOR, 0.0f, 1.0f}, {JOYSTICK_AXIS_ABSTRACT_LEFT_Y, COWL, ACTUATOR_COWL_FLAPS, JOYSTICK_AXIS_ABSTRACT_LEFT_Y, 1.0f, BOUNDS_ACTUATOR, 0.0f, 1.0f}, {JOYSTICK_AXIS_ABSTRACT_LEFT_Y, TRIM, ACTUATOR_POWER, JOYSTICK_AXIS_ABSTRACT_LEFT_Y, -1.0f, BOUNDS_ACTUATOR, 0.0f, 1.0f}, {JOYSTICK_AXIS_ABSTRACT_LEFT_Y, SPEEDBRAKE, ACTUATOR_POWER, JOYSTICK_AXIS_ABSTRACT_LEFT_Y, -1.0f, BOUNDS_ACTUATOR, 0.0f, 1.0f}, {JOYSTICK_AXIS_ABSTRACT_LEFT_Y, KEYBOARD, ACTUATOR_POWER, JOYSTICK_AXIS_ABSTRACT_LEFT_Y, -1.0f, BOUNDS_ACTUATOR, 0.0f, 1.0f}}, 8, 0, 500, 0};
+static AircraftProfile aircraftProfile = {0};
+static FrameState frameState = {-1, 0, 0, 0, 0.0f};
+static IndicatorValues indicatorValues = {0.0f, -3.0f, -3.0f};
+static ResponseCurve axisResponseCurves[NUM_ABSTRACT_AXES], accelerationResponseCurve;
+static const CurveConfig accelerationCurveConfig = {CURVE_QUADRATIC, 0, {{0.0f}}};
+static OneEuroFilter axisFilterStates[4];
+static float integrationTimeAccumulator = 0.0f;
+static const ActuatorHandler actuatorHandlers[NUM_ACTUATORS] = {NULL, ActuateThrottle, ActuateCollective, ActuateSpeedbrake, ActuateProp, ActuateMixture, ActuateCowlFlaps};
+static CompiledAxisBinding compiledAxisBindings[NUM_MODES][NUM_ABSTRACT_AXES];
+// the direction in which each axis deflects when it is pushed forward or to the right, an inverted binding moves its actuator the other way
+static const float axisDirections[NUM_ABSTRACT_AXES] = {1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f};
+static DeviceCalibration deviceCalibrations[MAX_CALIBRATED_DEVICES];
+static int numDeviceCalibrations = 0, deviceCalibrationIndex = -1, calibrationChanged = 0;
+static AxisCalibrationState axisCalibrationStates[4], triggerCalibrationStates[2];
+static ReadPlan readPlan = {XBOX360, 0, 0, 0};
+static CachedWrite writeCache[WRITE_CACHE_SIZE];
+static XPLMCommandRef activeCommands[MAX_ACTIVE_COMMANDS];
+static int numActiveCommands = 0;
+static int writeCacheSize = 0;
+static Mode mode = DEFAULT, bindingsMode = DEFAULT;
 static ConfigurationStep configurationStep = START;
 static GLuint indicatorsProgram = 0, indicatorsFragmentShader = 0, keyboardKeyProgram = 0, keyboardKeyFragmentShader = 0;
-static int *pushedJoystickButtonAssignments = NULL;
+static ModeLayer modeLayers[MAX_MODE_LAYERS];
+static int numModeLayers = 0;
+static ModeOverlayTable modeOverlayTable;
+static int modeOverlaysStale = 1, modeOverlayRetries = 0;
+static XPLMCommandRef dispatchedCommands[MAX_DISPATCH_BUTTONS];
+static uint64_t dispatchButtonStates = 0;
+static int dispatchWindowStart = -1, dispatchWindowCount = 0;
+static int dispatchSavedAssignments[MAX_DISPATCH_BUTTONS];
 static XPLMWindowID indicatorsWindow = NULL, keyboardWindow = NULL;
+static XPLMFlightLoopID inputFlightLoop = NULL, housekeepingFlightLoop = NULL;
+static int inputFlightLoopIdle = 0;
 
 #if IBM
 static HANDLE hidDeviceThread = 0;
@@ -813,14 +1312,44 @@ static pthread_t hidDeviceThread = 0;
 
 #if LIN
 static Display *display = NULL;
+static pthread_t inputThread;
+static int inputThreadStarted = 0;
+static volatile int inputThreadRun = 1, inputThreadRunning = 0;
+static const int evdevAxisCodes[NUM_CONTROLLER_AXES] = {ABS_X, ABS_Y, ABS_RX, ABS_RY, ABS_Z, ABS_RZ};
+static ControllerState controllerStates[3];
+static atomic_uint controllerStateExchange = 1, controllerPressedButtons = 0, controllerReleasedButtons = 0;
+static unsigned int controllerStateBackIndex = 2;
+static InputThreadConfig inputThreadConfig = {0};
+static pthread_mutex_t inputThreadConfigMutex = PTHREAD_MUTEX_INITIALIZER;
+static atomic_uint inputThreadConfigVersion = 0;
 #else
 static int hidInitialized = 0;
 static volatile int hidDeviceThreadRun = 1;
+static volatile int hidDeviceThreadActive = 0;
 #endif
 
+static const char *commandNames[NUM_COMMANDS] = {[COMMAND_GENERAL_LEFT] = "sim/general/left", [COMMAND_GENERAL_RIGHT] = "sim/general/right", [COMMAND_GENERAL_UP] = "sim/general/up", [COMMAND_GENERAL_DOWN] = "sim/general/down", [COMMAND_GENERAL_ROT_LEFT] = "sim/general/rot_left", [COMMAND_GENERAL_ROT_RIGHT] = "sim/general/rot_right", [COMMAND_GENERAL_FORWARD] = "sim/general/forward", [COMMAND_GENERAL_BACKWARD] = "sim/general/backward", [COMMAND_GENERAL_ZOOM_IN] = "sim/general/zoom_in", [COMMAND_GENERAL_ZOOM_OUT] = "sim/general/zoom_out", [COMMAND_VIEW_3D_COCKPIT_COMMAND_LOOK] = "sim/view/3d_cockpit_cmnd_look", [COMMAND_VIEW_FORWARD_WITH_2D_PANEL] = "sim/view/forward_with_2d_panel", [COMMAND_VIEW_FORWARD_WITH_HUD] = "sim/view/forward_with_hud", [COMMAND_VIEW_CHASE] = "sim/view/chase", [COMMAND_VIEW_CIRCLE] = "sim/view/circle", [COMMAND_AUTOPILOT_SERVOS_OFF_ANY] = "sim/autopilot/servos_off_any", [COMMAND_AUTOPILOT_CONTROL_WHEEL_STEER] = "sim/autopilot/control_wheel_steer", [COMMAND_AUTOPILOT_FLIGHT_DIR_DOWN] = "sim/autopilot/Flight-Dir Down", [COMMAND_FLIGHT_CONTROLS_AILERON_TRIM_LEFT] = "sim/flight_controls/aileron_trim_left", [COMMAND_FLIGHT_CONTROLS_AILERON_TRIM_RIGHT] = "sim/flight_controls/aileron_trim_right", [COMMAND_FLIGHT_CONTROLS_AILERON_TRIM_CENTER] = "sim/flight_controls/aileron_trim_center", [COMMAND_FLIGHT_CONTROLS_RUDDER_TRIM_LEFT] = "sim/flight_controls/rudder_trim_left", [COMMAND_FLIGHT_CONTROLS_RUDDER_TRIM_RIGHT] = "sim/flight_controls/rudder_trim_right", [COMMAND_FLIGHT_CONTROLS_RUDDER_TRIM_CENTER] = "sim/flight_controls/rudder_trim_center", [COMMAND_FLIGHT_CONTROLS_PITCH_TRIM_UP] = "sim/flight_controls/pitch_trim_up", [COMMAND_FLIGHT_CONTROLS_PITCH_TRIM_DOWN] = "sim/flight_controls/pitch_trim_down", [COMMAND_FLIGHT_CONTROLS_FLAPS_UP] = "sim/flight_controls/flaps_up", [COMMAND_FLIGHT_CONTROLS_FLAPS_DOWN] = "sim/flight_controls/flaps_down", [COMMAND_FLIGHT_CONTROLS_LANDING_GEAR_TOGGLE] = "sim/flight_controls/landing_gear_toggle", [COMMAND_FLIGHT_CONTROLS_BRAKES_TOGGLE_MAX] = "sim/flight_controls/brakes_toggle_max", [COMMAND_FLIGHT_CONTROLS_SPEED_BRAKES_UP_ONE] = "sim/flight_controls/speed_brakes_up_one", [COMMAND_FLIGHT_CONTROLS_SPEED_BRAKES_DOWN_ONE] = "sim/flight_controls/speed_brakes_down_one", [COMMAND_ENGINES_CARB_HEAT_TOGGLE] = "sim/engines/carb_heat_toggle", [COMMAND_NONE] = "sim/none/none", [COMMAND_AS350_FORCE_TRIM] = "AS350/Trim/Force_Trim", [COMMAND_AS350_TRIM_RELEASE] = "AS350/Trim/Trim_Release", [COMMAND_B407_FORCE_TRIM] = "B407/flight_controls/force_trim", [COMMAND_B407_TRIM_RELEASE] = "B407/flight_controls/trim_release", [COMMAND_EC135_BEEP_LEFT] = "ec135/autopilot/beep_left", [COMMAND_EC135_BEEP_RIGHT] = "ec135/autopilot/beep_right", [COMMAND_EC135_BEEP_FWD] = "ec135/autopilot/beep_fwd", [COMMAND_EC135_BEEP_AFT] = "ec135/autopilot/beep_aft", [COMMAND_B738_CAPT_DISCO_PRESS] = "laminar/B738/autopilot/capt_disco_press", [COMMAND_HEAD_SHAKE_STOP] = "simcoders/headshake/stop"};
+static XPLMCommandRef commandRefs[NUM_COMMANDS] = {NULL};
+static const char *pluginSignatures[NUM_PLUGINS] = {[PLUGIN_DREAMFOIL_AS350] = DREAMFOIL_AS350_PLUGIN_SIGNATURE, [PLUGIN_DREAMFOIL_B407] = DREAMFOIL_B407_PLUGIN_SIGNATURE, [PLUGIN_HEAD_SHAKE] = HEAD_SHAKE_PLUGIN_SIGNATURE, [PLUGIN_ROTORSIM_EC135] = ROTORSIM_EC135_PLUGIN_SIGNATURE, [PLUGIN_X_IVAP] = X_IVAP_PLUGIN_SIGNATURE, [PLUGIN_X_XSQUAWKBOX] = X_XSQUAWKBOX_PLUGIN_SIGNATURE, [PLUGIN_TOLISS] = TOLISS_PLUGIN_SIGNATURE, [PLUGIN_ZIBO] = ZIBO_PLUGIN_SIGNATURE};
+static unsigned int enabledPlugins = 0;
+static const char *axisNames[NUM_ABSTRACT_AXES] = {[JOYSTICK_AXIS_ABSTRACT_LEFT_X] = "Left Stick X", [JOYSTICK_AXIS_ABSTRACT_LEFT_Y] = "Left Stick Y", [JOYSTICK_AXIS_ABSTRACT_RIGHT_X] = "Right Stick X", [JOYSTICK_AXIS_ABSTRACT_RIGHT_Y] = "Right Stick Y", [JOYSTICK_AXIS_ABSTRACT_LEFT_TRIGGER] = "Left Trigger", [JOYSTICK_AXIS_ABSTRACT_RIGHT_TRIGGER] = "Right Trigger"};
+static const char *curveTypeNames[NUM_CURVE_TYPES] = {[CURVE_LINEAR] = "Linear", [CURVE_QUADRATIC] = "Quadratic", [CURVE_CUBIC] = "Cubic", [CURVE_S] = "S-Curve", [CURVE_CUSTOM] = "Custom"};
+static const char *modeNames[NUM_MODES] = {[DEFAULT] = "Default", [LOOK] = "Look", [SWITCH_VIEW] = "Switch View", [PROP] = "Prop", [MIXTURE] = "Mixture", [COWL] = "Cowl Flaps", [TRIM] = "Trim", [SPEEDBRAKE] = "Speedbrake", [MOUSE] = "Mouse", [KEYBOARD] = "Keyboard"};
+static const char *actuatorNames[NUM_ACTUATORS] = {[ACTUATOR_POWER] = "Power", [ACTUATOR_THROTTLE] = "Throttle", [ACTUATOR_COLLECTIVE] = "Collective", [ACTUATOR_SPEEDBRAKE] = "Speedbrake", [ACTUATOR_PROP] = "Prop", [ACTUATOR_MIXTURE] = "Mixture", [ACTUATOR_COWL_FLAPS] = "Cowl Flaps"};
+static const char *thirdPartyDataRefNames[NUM_THIRD_PARTY_DATAREFS] = {[THIRD_PARTY_DATAREF_AIRBUS_THROTTLE_INPUT] = "AirbusFBW/throttle_input"};
+static XPLMDataRef thirdPartyDataRefs[NUM_THIRD_PARTY_DATAREFS] = {NULL};
+static int thirdPartyDataRefsStale = 1;
 static XPLMCommandRef cycleResetViewCommand = NULL, toggleArmSpeedBrakeOrToggleCarbHeatCommand = NULL, cwsOrDisconnectAutopilotCommand = NULL, lookModifierCommand = NULL, propPitchOrThrottleModifierCommand = NULL, mixtureControlModifierCommand = NULL, cowlFlapModifierCommand = NULL, trimModifierCommand = NULL, trimResetCommand = NULL, toggleMousePointerControlCommand = NULL, pushToTalkCommand = NULL, toggleLeftMouseButtonCommand = NULL, toggleReverseCommand = NULL, toggleRightMouseButtonCommand = NULL, scrollUpCommand = NULL, scrollDownCommand = NULL, keyboardSelectorUpCommand = NULL, keyboardSelectorDownCommand = NULL, keyboardSelectorLeftCommand = NULL, keyboardSelectorRightCommand = NULL, pressKeyboardKeyCommand = NULL, lockKeyboardKeyCommand = NULL;
-static XPLMDataRef preconfiguredApTypeDataRef = NULL, acfCockpitTypeDataRef = NULL, acfPeXDataRef = NULL, acfPeYDataRef = NULL, acfPeZDataRef = NULL, acfICAODataRef = NULL, acfRSCRedlinePrpDataRef = NULL, acfNumEnginesDataRef = NULL, acfFeatheredPitchDataRef = NULL, acfHasBetaDataRef = NULL, acfSbrkEQDataRef = NULL, acfRevthrustEqDataRef = NULL, acfEnTypeDataRef = NULL, acfPropTypeDataRef = NULL, acfMinPitchDataRef = NULL, acfMaxPitchDataRef = NULL, cinemaVeriteDataRef = NULL, pilotsHeadPsiDataRef = NULL, pilotsHeadTheDataRef = NULL, viewTypeDataRef = NULL, vrEnabledDataRef = NULL, hasJoystickDataRef = NULL, joystickPitchNullzoneDataRef = NULL, joystickRollNullzoneDataRef = NULL, joystickHeadingNullzoneDataRef = NULL, joystickPitchSensitivityDataRef = NULL, joystickRollSensitivityDataRef = NULL, joystickHeadingSensitivityDataRef = NULL, joystickAxisAssignmentsDataRef = NULL, joystickAxisReverseDataRef = NULL, joystickAxisValuesDataRef = NULL, joystickButtonAssignmentsDataRef = NULL, joystickButtonValuesDataRef = NULL, leftBrakeRatioDataRef = NULL, rightBrakeRatioDataRef = NULL, sbrkrqstDataRef = NULL, speedbrakeRatioDataRef = NULL, throttleRatioAllDataRef = NULL, throttleJetRevRatioAllDataRef = NULL, throttleBetaRevRatioAllDataRef = NULL, propPitchDegDataRef = NULL, propRotationSpeedRadSecAllDataRef = NULL, mixtureRatioAllDataRef = NULL, cowlFlapRatioDataRef = NULL, overrideToeBrakesDataRef = NULL;
-static XPWidgetID settingsWidget = NULL, dualShock4ControllerRadioButton = NULL, xbox360ControllerRadioButton = NULL, configurationStatusCaption = NULL, startConfigurationtButton = NULL, showIndicatorsCheckbox = NULL;
+static XPLMDataRef preconfiguredApTypeDataRef = NULL, acfCockpitTypeDataRef = NULL, acfPeXDataRef = NULL, acfPeYDataRef = NULL, acfPeZDataRef = NULL, acfICAODataRef = NULL, acfRSCRedlinePrpDataRef = NULL, acfNumEnginesDataRef = NULL, acfFeatheredPitchDataRef = NULL, acfHasBetaDataRef = NULL, acfSbrkEQDataRef = NULL, acfRevthrustEqDataRef = NULL, acfEnTypeDataRef = NULL, acfPropTypeDataRef = NULL, acfMinPitchDataRef = NULL, acfMaxPitchDataRef = NULL, cinemaVeriteDataRef = NULL, pilotsHeadPsiDataRef = NULL, pilotsHeadTheDataRef = NULL, viewTypeDataRef = NULL, vrEnabledDataRef = NULL, hasJoystickDataRef = NULL, pausedDataRef = NULL, joystickPitchNullzoneDataRef = NULL, joystickRollNullzoneDataRef = NULL, joystickHeadingNullzoneDataRef = NULL, joystickPitchSensitivityDataRef = NULL, joystickRollSensitivityDataRef = NULL, joystickHeadingSensitivityDataRef = NULL, joystickAxisAssignmentsDataRef = NULL, joystickAxisReverseDataRef = NULL, joystickAxisValuesDataRef = NULL, joystickButtonAssignmentsDataRef = NULL, joystickButtonValuesDataRef = NULL, leftBrakeRatioDataRef = NULL, rightBrakeRatioDataRef = NULL, sbrkrqstDataRef = NULL, speedbrakeRatioDataRef = NULL, throttleRatioAllDataRef = NULL, throttleJetRevRatioAllDataRef = NULL, throttleBetaRevRatioAllDataRef = NULL, propPitchDegDataRef = NULL, propRotationSpeedRadSecAllDataRef = NULL, mixtureRatioAllDataRef = NULL, cowlFlapRatioDataRef = NULL, overrideToeBrakesDataRef = NULL;
+static XPWidgetID settingsWidget = NULL, dualShock4ControllerRadioButton = NULL, xbox360ControllerRadioButton = NULL, configurationStatusCaption = NULL, startConfigurationtButton = NULL, showIndicatorsCheckbox = NULL, smoothStickInputCheckbox = NULL, directInputCheckbox = NULL, directButtonDispatchCheckbox = NULL, axisSettingsButton = NULL;
+static XPWidgetID axisSettingsWidget = NULL, curveTypeButtons[NUM_ABSTRACT_AXES] = {NULL}, curvePointsTextFields[NUM_ABSTRACT_AXES] = {NULL}, deadzoneTypeButtons[2] = {NULL};
+// the inner, outer and anti-deadzone of each stick
+static XPWidgetID deadzoneSliders[2][3] = {{NULL}}, deadzoneValueCaptions[2][3] = {{NULL}};
+// the minimum cutoff and beta of the filter of each stick axis
+static XPWidgetID filterSliders[4][2] = {{NULL}}, filterValueCaptions[4][2] = {{NULL}};
+static XPWidgetID bindingsModeButton = NULL, actuatorButtons[NUM_ABSTRACT_AXES] = {NULL}, bindingCurveButtons[NUM_ABSTRACT_AXES] = {NULL}, invertCheckboxes[NUM_ABSTRACT_AXES] = {NULL}, customBoundsCheckboxes[NUM_ABSTRACT_AXES] = {NULL};
+// the minimum and the maximum of the custom bounds of each binding
+static XPWidgetID boundsSliders[NUM_ABSTRACT_AXES][2] = {{NULL}}, boundsValueCaptions[NUM_ABSTRACT_AXES][2] = {{NULL}};
 
 PLUGIN_API int XPluginStart(char *outName, char *outSig, char *outDesc)
 {
@@ -996,6 +1525,7 @@ PLUGIN_API int XPluginStart(char *outName, char *outSig, char *outDesc)
     viewTypeDataRef = XPLMFindDataRef("sim/graphics/view/view_type");
     vrEnabledDataRef = XPLMFindDataRef("sim/graphics/VR/enabled");
     hasJoystickDataRef = XPLMFindDataRef("sim/joystick/has_joystick");
+    pausedDataRef = XPLMFindDataRef("sim/time/paused");
     joystickPitchNullzoneDataRef = XPLMFindDataRef("sim/joystick/joystick_pitch_nullzone");
     joystickRollNullzoneDataRef = XPLMFindDataRef("sim/joystick/joystick_roll_nullzone");
     joystickHeadingNullzoneDataRef = XPLMFindDataRef("sim/joystick/joystick_heading_nullzone");
@@ -1068,6 +1598,9 @@ PLUGIN_API int XPluginStart(char *outName, char *outSig, char *outDesc)
     XPLMRegisterCommandHandler(pressKeyboardKeyCommand, PressKeyboardKeyCommand, 1, NULL);
     XPLMRegisterCommandHandler(lockKeyboardKeyCommand, LockKeyboardKeyCommand, 1, NULL);
 
+    // resolve the commands we send or assign
+    ResolveCommands();
+
     // initialize indicator default position
     int right = 0, bottom = 0;
     XPLMGetScreenBoundsGlobal(NULL, NULL, &right, &bottom);
@@ -1086,17 +1619,28 @@ PLUGIN_API int XPluginStart(char *outName, char *outSig, char *outDesc)
     {
         Settings readSettings = {0};
         const size_t settingsSize = sizeof(Settings);
-        if (fread(&readSettings, settingsSize, 1, file) == settingsSize)
+        // settings files written with a different layout are ignored and the defaults are kept
+        if (fread(&readSettings, settingsSize, 1, file) == 1 && readSettings.version == SETTINGS_VERSION)
             memcpy(&settings, &readSettings, settingsSize);
 
         fclose(file);
     }
 
+    LoadCalibration();
+
     // acquire toe brake control if required
     UpdateToeBrakeControl();
 
-    // register flight loop callbacks
-    XPLMRegisterFlightLoopCallback(FlightLoopCallback, -1, NULL);
+    UpdateAircraftProfile();
+
+    // create flight loops - input is processed before the flight model so that control inputs take effect in the same frame
+    XPLMCreateFlightLoop_t inputFlightLoopParams = {sizeof(XPLMCreateFlightLoop_t), xplm_FlightLoop_Phase_BeforeFlightModel, InputFlightLoopCallback, NULL};
+    inputFlightLoop = XPLMCreateFlightLoop(&inputFlightLoopParams);
+    XPLMScheduleFlightLoop(inputFlightLoop, -1.0f, 1);
+
+    XPLMCreateFlightLoop_t housekeepingFlightLoopParams = {sizeof(XPLMCreateFlightLoop_t), xplm_FlightLoop_Phase_AfterFlightModel, HousekeepingFlightLoopCallback, NULL};
+    housekeepingFlightLoop = XPLMCreateFlightLoop(&housekeepingFlightLoopParams);
+    XPLMScheduleFlightLoop(housekeepingFlightLoop, -1.0f, 1);
 
     // initialize indicators window if necessary
     UpdateIndicatorsWindow(-1);
@@ -1122,11 +1666,15 @@ PLUGIN_API void XPluginStop(void)
 {
     ReleaseAllKeys();
 
+    SaveCalibration();
+
     CleanupShader(indicatorsProgram, indicatorsFragmentShader, 1);
     CleanupShader(keyboardKeyProgram, keyboardKeyFragmentShader, 1);
 
-    // revert any remaining button assignments
-    PopButtonAssignments();
+    // revert the assignments of any remaining mode layers and hand the dispatched buttons back to X-Plane, which saves the assignments in its preferences
+    while (numModeLayers > 0)
+        PopModeLayer(modeLayers[numModeLayers - 1].mode);
+    UnclaimDispatchButtons();
 
     // unregister custom commands
     XPLMUnregisterCommandHandler(cycleResetViewCommand, ResetSwitchViewCommand, 1, NULL);
@@ -1152,8 +1700,11 @@ PLUGIN_API void XPluginStop(void)
     XPLMUnregisterCommandHandler(pressKeyboardKeyCommand, PressKeyboardKeyCommand, 1, NULL);
     XPLMUnregisterCommandHandler(lockKeyboardKeyCommand, LockKeyboardKeyCommand, 1, NULL);
 
-    // register flight loop callbacks
-    XPLMUnregisterFlightLoopCallback(FlightLoopCallback, NULL);
+    // destroy flight loops
+    XPLMDestroyFlightLoop(inputFlightLoop);
+    inputFlightLoop = NULL;
+    XPLMDestroyFlightLoop(housekeepingFlightLoop);
+    housekeepingFlightLoop = NULL;
 
     // release toe brake control
     XPLMSetDatai(overrideToeBrakesDataRef, 0);
@@ -1168,6 +1719,10 @@ PLUGIN_API void XPluginStop(void)
 #endif
     hid_exit();
 #else
+    inputThreadRun = 0;
+    if (inputThreadStarted)
+        pthread_join(inputThread, NULL);
+
     if (display)
         XCloseDisplay(display);
 #endif
@@ -1179,6 +1734,11 @@ PLUGIN_API void XPluginDisable(void)
 
 PLUGIN_API int XPluginEnable(void)
 {
+    // the plane might have changed while we were disabled
+    UpdateAircraftProfile();
+    UpdateEnabledPlugins();
+    thirdPartyDataRefsStale = 1;
+
     return 1;
 }
 
@@ -1197,13 +1757,27 @@ PLUGIN_API void XPluginReceiveMessage(XPLMPluginID inFromWho, long inMessage, vo
 
         thrustReverserMode = 0;
 
+        // the properties of the airframe do not change during flight, so we only read them once when a plane is loaded
+        UpdateAircraftProfile();
+
+        // the new plane comes with its own control positions
+        ClearWriteCache();
+
+        // aircraft plugins might have created new commands
+        ResolveCommands();
+
         // reinitialize indicators window if necessary
         UpdateIndicatorsWindow(-1);
 
     case XPLM_MSG_AIRPORT_LOADED:
+        UpdateEnabledPlugins();
+
+        // aircraft plugins publish their datarefs after the plane itself has been loaded, so we resolve them during the next flight loop
+        thirdPartyDataRefsStale = 1;
+
         // schedule a switch to the 3D cockpit view during the next flight loop
         switchTo3DCommandLook = 0;
-        if (!Has2DPanel())
+        if (!aircraftProfile.has2DPanel)
             switchTo3DCommandLook = 1;
         break;
 
@@ -1233,65 +1807,560 @@ PLUGIN_API void XPluginReceiveMessage(XPLMPluginID inFromWho, long inMessage, vo
     }
 }
 
-static int AxisIndex(int abstractAxisIndex)
+#if LIN
+static const ControllerState *AcquireControllerState(void)
 {
-    switch (settings.controllerType)
+    static unsigned int frontIndex = 0;
+    static int received = 0;
+
+    if (!inputThreadRunning)
+        return NULL;
+
+    // swap our buffer with the one the input thread published last, if it published anything since we last looked
+    if (atomic_load_explicit(&controllerStateExchange, memory_order_relaxed) & 4u)
     {
-    case XBOX360:
-        switch (abstractAxisIndex)
-        {
-        case JOYSTICK_AXIS_ABSTRACT_LEFT_X:
-            return JOYSTICK_AXIS_XBOX360_LEFT_X + settings.axisOffset;
-        case JOYSTICK_AXIS_ABSTRACT_LEFT_Y:
-            return JOYSTICK_AXIS_XBOX360_LEFT_Y + settings.axisOffset;
-        case JOYSTICK_AXIS_ABSTRACT_RIGHT_X:
-            return JOYSTICK_AXIS_XBOX360_RIGHT_X + settings.axisOffset;
-        case JOYSTICK_AXIS_ABSTRACT_RIGHT_Y:
-            return JOYSTICK_AXIS_XBOX360_RIGHT_Y + settings.axisOffset;
-        default:
-            return -1;
-        }
-        break;
-    case DS4:
-        switch (abstractAxisIndex)
+        frontIndex = atomic_exchange_explicit(&controllerStateExchange, frontIndex, memory_order_acq_rel) & 3u;
+        received = 1;
+    }
+
+    if (!received)
+        return NULL;
+
+    // edges are collected separately, so that no press or release gets lost when the input thread publishes several states within one frame
+    ControllerState *controllerState = &controllerStates[frontIndex];
+    controllerState->pressedButtons = atomic_exchange_explicit(&controllerPressedButtons, 0, memory_order_relaxed);
+    controllerState->releasedButtons = atomic_exchange_explicit(&controllerReleasedButtons, 0, memory_order_relaxed);
+
+    return controllerState;
+}
+#endif
+
+static void ActuateCollective(float deflection, float sensitivityMultiplier, float minimum, float maximum)
+{
+    const int acfNumEngines = aircraftProfile.numEngines;
+    const float *acfMinPitch = aircraftProfile.minPitch;
+    const float *acfMaxPitch = aircraftProfile.maxPitch;
+    if (FloatsEqual(deflection, 0.0f))
+        return;
+
+    float propPitchDeg[8];
+    XPLMGetDatavf(propPitchDegDataRef, propPitchDeg, 0, acfNumEngines);
+
+    // increase / decrease prop pitch but stay within the bounds of [acfMinPitch, acfMaxPitch], the rate ranges from acfMinPitch at the edge of the nullzone to acfMaxPitch at full deflection
+    int changed = 0;
+    for (int i = 0; i < acfNumEngines; i++)
+        changed |= IntegrateDeflection(deflection, sensitivityMultiplier * (acfMaxPitch[i] - acfMinPitch[i] + acfMinPitch[i] / fabsf(deflection)), Normalize(minimum, 0.0f, 1.0f, acfMinPitch[i], acfMaxPitch[i]), Normalize(maximum, 0.0f, 1.0f, acfMinPitch[i], acfMaxPitch[i]), &propPitchDeg[i]);
+
+    if (changed)
+        SetDatavfCached(propPitchDegDataRef, propPitchDeg, 0, acfNumEngines);
+}
+
+static void ActuateCowlFlaps(float deflection, float sensitivityMultiplier, float minimum, float maximum)
+{
+    const int acfNumEngines = aircraftProfile.numEngines;
+    float cowlFlapRatio[8];
+    XPLMGetDatavf(cowlFlapRatioDataRef, cowlFlapRatio, 0, acfNumEngines);
+
+    // increase / decrease cowl flap setting but stay within the bounds of [0.0, 1.0]
+    int changed = 0;
+    for (int i = 0; i < acfNumEngines; i++)
+        changed |= IntegrateDeflection(deflection, sensitivityMultiplier, minimum, maximum, &cowlFlapRatio[i]);
+
+    if (changed)
+        SetDatavfCached(cowlFlapRatioDataRef, cowlFlapRatio, 0, acfNumEngines);
+}
+
+static void ActuateMixture(float deflection, float sensitivityMultiplier, float minimum, float maximum)
+{
+    // increase / decrease mixture setting but stay within the bounds of [0.0, 1.0]
+    float mixtureRatioAll = XPLMGetDataf(mixtureRatioAllDataRef);
+    if (IntegrateDeflection(deflection, sensitivityMultiplier, minimum, maximum, &mixtureRatioAll))
+        SetDatafCached(mixtureRatioAllDataRef, mixtureRatioAll);
+}
+
+static void ActuateProp(float deflection, float sensitivityMultiplier, float minimum, float maximum)
+{
+    const float acfFeatheredPitch = aircraftProfile.featheredPitch;
+    const float acfRSCRedlinePrp = aircraftProfile.rscRedlinePrp;
+    if (FloatsEqual(deflection, 0.0f))
+        return;
+
+    // increase / decrease prop pitch but don't exceed the bounds of the range between feathered pitch and redline, the rate ranges from acfFeatheredPitch at the edge of the nullzone to acfRSCRedlinePrp at full deflection
+    float propRotationSpeedRadSecAll = XPLMGetDataf(propRotationSpeedRadSecAllDataRef);
+    if (IntegrateDeflection(deflection, sensitivityMultiplier * (acfRSCRedlinePrp - acfFeatheredPitch + acfFeatheredPitch / fabsf(deflection)), Normalize(minimum, 0.0f, 1.0f, acfFeatheredPitch, acfRSCRedlinePrp), Normalize(maximum, 0.0f, 1.0f, acfFeatheredPitch, acfRSCRedlinePrp), &propRotationSpeedRadSecAll))
+        SetDatafCached(propRotationSpeedRadSecAllDataRef, propRotationSpeedRadSecAll);
+}
+
+static void ActuateSpeedbrake(float deflection, float sensitivityMultiplier, float minimum, float maximum)
+{
+    float speedbrakeRatio = XPLMGetDataf(speedbrakeRatioDataRef);
+
+    // de-arm speedbrake if armed
+    if (FloatsEqual(speedbrakeRatio, -0.5f))
+        speedbrakeRatio = 0.0f;
+
+    // the speedbrake takes the place of the throttle on gliders, so a positive deflection retracts it
+    if (IntegrateDeflection(-deflection, sensitivityMultiplier, minimum, maximum, &speedbrakeRatio))
+        SetDatafCached(speedbrakeRatioDataRef, speedbrakeRatio);
+}
+
+static void ActuateThrottle(float deflection, float sensitivityMultiplier, float minimum, float maximum)
+{
+    const XPLMDataRef throttleRatioDataRef = aircraftProfile.throttleRatioDataRef;
+
+    float lowerThrottleBound;
+    if (thrustReverserMode)
+    {
+        if (throttleRatioDataRef == throttleBetaRevRatioAllDataRef)
+            lowerThrottleBound = -2.0f;
+        else
+            lowerThrottleBound = -1.0f;
+    }
+    else
+        lowerThrottleBound = 0.0f;
+
+    // increase / decrease throttle setting but stay within the bounds of [lowerThrottleBound, 1.0]
+    float newThrottleRatioAll = GetThrottleRatio(throttleRatioDataRef);
+    if (IntegrateDeflection(deflection, sensitivityMultiplier, Normalize(minimum, 0.0f, 1.0f, lowerThrottleBound, 1.0f), Normalize(maximum, 0.0f, 1.0f, lowerThrottleBound, 1.0f), &newThrottleRatioAll))
+    {
+        SetDatafCached(throttleRatioDataRef, newThrottleRatioAll);
+        SetToLissThrottle(newThrottleRatioAll);
+    }
+}
+
+static void AddAxisOverlayEntry(AssignmentOverlay *axisOverlay, int index, int assignment)
+{
+    if (index < 0 || index >= 100)
+        return;
+
+    AddOverlayEntry(axisOverlay, index, assignment);
+}
+
+static void AddButtonOverlayEntry(AssignmentOverlay *buttonOverlay, int index, XPLMCommandRef command)
+{
+    if (index < 0 || index >= NUM_JOYSTICK_BUTTONS)
+        return;
+
+    AddOverlayEntry(buttonOverlay, index, (intptr_t)command);
+}
+
+static void AddOverlayEntry(AssignmentOverlay *overlay, int index, int assignment)
+{
+    // a later assignment of the same slot replaces the earlier one
+    AssignmentOverlayEntry *entry = FindOverlayEntry(overlay, index);
+
+    if (entry == NULL)
+    {
+        if (overlay->numEntries == MAX_OVERLAY_ENTRIES)
         {
-        case JOYSTICK_AXIS_ABSTRACT_LEFT_X:
-            return JOYSTICK_AXIS_DS4_LEFT_X + settings.axisOffset;
-        case JOYSTICK_AXIS_ABSTRACT_LEFT_Y:
-            return JOYSTICK_AXIS_DS4_LEFT_Y + settings.axisOffset;
-        case JOYSTICK_AXIS_ABSTRACT_RIGHT_X:
-            return JOYSTICK_AXIS_DS4_RIGHT_X + settings.axisOffset;
-        case JOYSTICK_AXIS_ABSTRACT_RIGHT_Y:
-            return JOYSTICK_AXIS_DS4_RIGHT_Y + settings.axisOffset;
-        default:
-            return -1;
+            XPLMDebugString(NAME ": Too many assignments for a single mode, ignoring assignment\n");
+            return;
         }
-        break;
-    default:
-        return -1;
+        entry = &overlay->entries[overlay->numEntries++];
+        entry->index = index;
     }
+
+    entry->assignment = assignment;
 }
 
-static int ButtonIndex(int abstractButtonIndex)
+static float AdvanceIntegrationClock(float elapsedTime)
 {
-    switch (settings.controllerType)
+    // nothing is integrated while the sim is paused and the time that is left over after a pause must not be caught up later
+    if (frameState.paused)
     {
-    case XBOX360:
-        switch (abstractButtonIndex)
-        {
-        case JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT:
-            return JOYSTICK_BUTTON_XBOX360_DPAD_LEFT + settings.buttonOffset;
-        case JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT:
-            return JOYSTICK_BUTTON_XBOX360_DPAD_RIGHT + settings.buttonOffset;
-        case JOYSTICK_BUTTON_ABSTRACT_DPAD_UP:
-            return JOYSTICK_BUTTON_XBOX360_DPAD_UP + settings.buttonOffset;
-        case JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN:
-            return JOYSTICK_BUTTON_XBOX360_DPAD_DOWN + settings.buttonOffset;
-        case JOYSTICK_BUTTON_ABSTRACT_FACE_LEFT:
-            return JOYSTICK_BUTTON_XBOX360_X + settings.buttonOffset;
-        case JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT:
-            return JOYSTICK_BUTTON_XBOX360_B + settings.buttonOffset;
-        case JOYSTICK_BUTTON_ABSTRACT_FACE_UP:
+        integrationTimeAccumulator = 0.0f;
+        return 0.0f;
+    }
+
+    // after a long frame we only catch up a limited amount of time, the remainder that doesn't fill a whole timestep is carried over to the next frame
+    integrationTimeAccumulator += elapsedTime < MAX_INTEGRATION_CATCH_UP ? elapsedTime : MAX_INTEGRATION_CATCH_UP;
+    const int numSteps = (int) (integrationTimeAccumulator / INTEGRATION_TIMESTEP);
+    const float integrationTime = numSteps * INTEGRATION_TIMESTEP;
+    integrationTimeAccumulator -= integrationTime;
+
+    return integrationTime;
+}
+
+static void ApplyAxisOverlay(const AssignmentOverlay *axisOverlay, AssignmentOverlay *previousAxisOverlay)
+{
+    if (previousAxisOverlay)
+        *previousAxisOverlay = *axisOverlay;
+
+    if (axisOverlay->numEntries == 0)
+        return;
+
+    // there are only a few axes, so the span between the lowest and the highest assigned axis is read and written with a single call each
+    int firstIndex = axisOverlay->entries[0].index, lastIndex = firstIndex;
+    for (int i = 1; i < axisOverlay->numEntries; i++)
+    {
+        if (axisOverlay->entries[i].index < firstIndex)
+            firstIndex = axisOverlay->entries[i].index;
+        else if (axisOverlay->entries[i].index > lastIndex)
+            lastIndex = axisOverlay->entries[i].index;
+    }
+
+    int assignments[100];
+    const int numAssignments = lastIndex - firstIndex + 1;
+    XPLMGetDatavi(joystickAxisAssignmentsDataRef, assignments, firstIndex, numAssignments);
+
+    for (int i = 0; i < axisOverlay->numEntries; i++)
+    {
+        const int offset = axisOverlay->entries[i].index - firstIndex;
+
+        if (previousAxisOverlay)
+            previousAxisOverlay->entries[i].assignment = assignments[offset];
+        assignments[offset] = axisOverlay->entries[i].assignment;
+    }
+
+    XPLMSetDatavi(joystickAxisAssignmentsDataRef, assignments, firstIndex, numAssignments);
+}
+
+static void ApplyButtonOverlay(const AssignmentOverlay *buttonOverlay, AssignmentOverlay *previousButtonOverlay)
+{
+    // sort the entries by button index so that neighbouring buttons can be written with a single call
+    AssignmentOverlay sortedButtonOverlay = *buttonOverlay;
+    for (int i = 1; i < sortedButtonOverlay.numEntries; i++)
+    {
+        const AssignmentOverlayEntry entry = sortedButtonOverlay.entries[i];
+        int j = i;
+        for (; j > 0 && sortedButtonOverlay.entries[j - 1].index > entry.index; j--)
+            sortedButtonOverlay.entries[j] = sortedButtonOverlay.entries[j - 1];
+        sortedButtonOverlay.entries[j] = entry;
+    }
+
+    if (previousButtonOverlay)
+        *previousButtonOverlay = sortedButtonOverlay;
+
+    // only touch the assigned slots, if requested remember what they were assigned to before
+    int runStart = 0;
+    while (runStart < sortedButtonOverlay.numEntries)
+    {
+        int runLength = 1;
+        while (runStart + runLength < sortedButtonOverlay.numEntries && sortedButtonOverlay.entries[runStart + runLength].index == sortedButtonOverlay.entries[runStart].index + runLength)
+            runLength++;
+
+        const int index = sortedButtonOverlay.entries[runStart].index;
+        int assignments[MAX_OVERLAY_ENTRIES];
+
+        if (previousButtonOverlay)
+        {
+            XPLMGetDatavi(joystickButtonAssignmentsDataRef, assignments, index, runLength);
+            for (int i = 0; i < runLength; i++)
+                previousButtonOverlay->entries[runStart + i].assignment = assignments[i];
+        }
+
+        for (int i = 0; i < runLength; i++)
+            assignments[i] = sortedButtonOverlay.entries[runStart + i].assignment;
+        XPLMSetDatavi(joystickButtonAssignmentsDataRef, assignments, index, runLength);
+
+        runStart += runLength;
+    }
+}
+
+static float ApplyOneEuroFilter(OneEuroFilter *filter, const FilterConfig *filterConfig, float value, float elapsedTime)
+{
+    if (!filterConfig->enabled || !filter->initialized || elapsedTime <= 0.0f)
+    {
+        filter->initialized = 1;
+        filter->value = value;
+        filter->derivative = 0.0f;
+        return value;
+    }
+
+    // smooth the rate of change and use it to raise the cutoff frequency, so that the filter smooths heavily while the stick is nearly still but barely lags when it moves fast
+    const float derivative = (value - filter->value) / elapsedTime;
+    filter->derivative += SmoothingFactor(filterConfig->derivativeCutoff, elapsedTime) * (derivative - filter->derivative);
+
+    const float cutoff = filterConfig->minCutoff + filterConfig->beta * fabsf(filter->derivative);
+    filter->value += SmoothingFactor(cutoff, elapsedTime) * (value - filter->value);
+
+    return filter->value;
+}
+
+static int AxisIndex(int abstractAxisIndex)
+{
+    switch (settings.controllerType)
+    {
+    case XBOX360:
+        switch (abstractAxisIndex)
+        {
+        case JOYSTICK_AXIS_ABSTRACT_LEFT_X:
+            return JOYSTICK_AXIS_XBOX360_LEFT_X + settings.axisOffset;
+        case JOYSTICK_AXIS_ABSTRACT_LEFT_Y:
+            return JOYSTICK_AXIS_XBOX360_LEFT_Y + settings.axisOffset;
+        case JOYSTICK_AXIS_ABSTRACT_RIGHT_X:
+            return JOYSTICK_AXIS_XBOX360_RIGHT_X + settings.axisOffset;
+        case JOYSTICK_AXIS_ABSTRACT_RIGHT_Y:
+            return JOYSTICK_AXIS_XBOX360_RIGHT_Y + settings.axisOffset;
+#if !IBM
+        case JOYSTICK_AXIS_ABSTRACT_LEFT_TRIGGER:
+            return JOYSTICK_AXIS_XBOX360_LEFT_TRIGGER + settings.axisOffset;
+        case JOYSTICK_AXIS_ABSTRACT_RIGHT_TRIGGER:
+            return JOYSTICK_AXIS_XBOX360_RIGHT_TRIGGER + settings.axisOffset;
+#endif
+        default:
+            return -1;
+        }
+        break;
+    case DS4:
+        switch (abstractAxisIndex)
+        {
+        case JOYSTICK_AXIS_ABSTRACT_LEFT_X:
+            return JOYSTICK_AXIS_DS4_LEFT_X + settings.axisOffset;
+        case JOYSTICK_AXIS_ABSTRACT_LEFT_Y:
+            return JOYSTICK_AXIS_DS4_LEFT_Y + settings.axisOffset;
+        case JOYSTICK_AXIS_ABSTRACT_RIGHT_X:
+            return JOYSTICK_AXIS_DS4_RIGHT_X + settings.axisOffset;
+        case JOYSTICK_AXIS_ABSTRACT_RIGHT_Y:
+            return JOYSTICK_AXIS_DS4_RIGHT_Y + settings.axisOffset;
+        case JOYSTICK_AXIS_ABSTRACT_LEFT_TRIGGER:
+            return JOYSTICK_AXIS_DS4_L2 + settings.axisOffset;
+        case JOYSTICK_AXIS_ABSTRACT_RIGHT_TRIGGER:
+            return JOYSTICK_AXIS_DS4_R2 + settings.axisOffset;
+        default:
+            return -1;
+        }
+        break;
+    default:
+        return -1;
+    }
+}
+
+static int AxisSettingsWidgetHandler(XPWidgetMessage inMessage, XPWidgetID inWidget, intptr_t inParam1, intptr_t inParam2)
+{
+    if (inMessage == xpMessage_CloseButtonPushed && XPIsWidgetVisible(axisSettingsWidget))
+    {
+        SaveSettings();
+        XPHideWidget(axisSettingsWidget);
+
+        return 1;
+    }
+    else if (inMessage == xpMsg_PushButtonPressed)
+    {
+        for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
+        {
+            if (inParam1 == (intptr_t)curveTypeButtons[i])
+            {
+                // cycle through the curve types, a custom curve takes over the points that have been entered for it
+                CurveConfig *curveConfig = &settings.axisCurves[i];
+                curveConfig->type = (CurveType)((curveConfig->type + 1) % NUM_CURVE_TYPES);
+                if (curveConfig->type == CURVE_CUSTOM)
+                {
+                    char text[MAX_CURVE_POINTS_TEXT_LENGTH];
+                    XPGetWidgetDescriptor(curvePointsTextFields[i], text, sizeof text);
+                    ParseCurvePoints(text, curveConfig);
+                }
+                UpdateAxisSettingsWidgets();
+
+                return 1;
+            }
+        }
+
+        for (int i = 0; i < 2; i++)
+        {
+            if (inParam1 == (intptr_t)deadzoneTypeButtons[i])
+            {
+                DeadzoneConfig *deadzoneConfig = &settings.stickDeadzones[i];
+                deadzoneConfig->type = deadzoneConfig->type == DEADZONE_RADIAL ? DEADZONE_AXIAL : DEADZONE_RADIAL;
+                UpdateAxisSettingsWidgets();
+
+                return 1;
+            }
+        }
+
+        if (inParam1 == (intptr_t)bindingsModeButton)
+        {
+            // the sticks look around in look mode, so there is nothing to bind there
+            do
+                bindingsMode = (Mode)((bindingsMode + 1) % NUM_MODES);
+            while (bindingsMode == LOOK);
+            UpdateAxisSettingsWidgets();
+
+            return 1;
+        }
+
+        for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
+        {
+            AxisBinding *axisBinding = FindAxisBinding(bindingsMode, i);
+
+            if (inParam1 == (intptr_t)actuatorButtons[i])
+            {
+                // cycle through the actuators, after the last one the binding is removed
+                if (axisBinding == NULL)
+                {
+                    if (settings.numAxisBindings < 0 || settings.numAxisBindings >= MAX_AXIS_BINDINGS)
+                        return 1;
+
+                    const AxisBinding newAxisBinding = {i, bindingsMode, ACTUATOR_POWER, i, axisDirections[i], BOUNDS_ACTUATOR, 0.0f, 1.0f};
+                    settings.axisBindings[settings.numAxisBindings++] = newAxisBinding;
+                }
+                else if (axisBinding->actuator >= ACTUATOR_POWER && axisBinding->actuator < NUM_ACTUATORS - 1)
+                    axisBinding->actuator = (Actuator)(axisBinding->actuator + 1);
+                else
+                {
+                    const int index = (int)(axisBinding - settings.axisBindings);
+                    memmove(axisBinding, axisBinding + 1, (size_t)(settings.numAxisBindings - index - 1) * sizeof(AxisBinding));
+                    settings.numAxisBindings--;
+                }
+                RecompileAxisBindings(bindingsMode, i);
+                UpdateAxisSettingsWidgets();
+
+                return 1;
+            }
+            else if (inParam1 == (intptr_t)bindingCurveButtons[i] && axisBinding != NULL)
+            {
+                // any axis' response curve can shape the binding
+                axisBinding->curve = axisBinding->curve >= 0 && axisBinding->curve < NUM_ABSTRACT_AXES - 1 ? axisBinding->curve + 1 : 0;
+                RecompileAxisBindings(bindingsMode, i);
+                UpdateAxisSettingsWidgets();
+
+                return 1;
+            }
+        }
+    }
+    else if (inMessage == xpMsg_ButtonStateChanged)
+    {
+        for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
+        {
+            AxisBinding *axisBinding = FindAxisBinding(bindingsMode, i);
+            if (axisBinding == NULL)
+                continue;
+
+            if (inParam1 == (intptr_t)invertCheckboxes[i])
+                axisBinding->rate = -axisBinding->rate;
+            else if (inParam1 == (intptr_t)customBoundsCheckboxes[i])
+                axisBinding->boundsSource = axisBinding->boundsSource == BOUNDS_CUSTOM ? BOUNDS_ACTUATOR : BOUNDS_CUSTOM;
+            else
+                continue;
+
+            RecompileAxisBindings(bindingsMode, i);
+            UpdateAxisSettingsWidgets();
+
+            return 1;
+        }
+    }
+    else if (inMessage == xpMsg_ScrollBarSliderPositionChanged)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            // the leftmost position of the inner and anti-deadzone sliders stands for a negative value
+            DeadzoneConfig *deadzoneConfig = &settings.stickDeadzones[i];
+            float *values[3] = {&deadzoneConfig->inner, &deadzoneConfig->outer, &deadzoneConfig->antiDeadzone};
+            for (int j = 0; j < 3; j++)
+            {
+                if (inParam1 == (intptr_t)deadzoneSliders[i][j])
+                {
+                    const int position = (int)XPGetWidgetProperty(deadzoneSliders[i][j], xpProperty_ScrollBarSliderPosition, 0);
+                    *values[j] = position < 0 ? -1.0f : position / 100.0f;
+                    UpdateAxisSettingsWidgets();
+
+                    return 1;
+                }
+            }
+        }
+
+        for (int i = 0; i < 4; i++)
+        {
+            // both filter parameters are set in steps of a tenth
+            FilterConfig *filterConfig = &settings.axisFilters[i];
+            float *values[2] = {&filterConfig->minCutoff, &filterConfig->beta};
+            for (int j = 0; j < 2; j++)
+            {
+                if (inParam1 == (intptr_t)filterSliders[i][j])
+                {
+                    *values[j] = (int)XPGetWidgetProperty(filterSliders[i][j], xpProperty_ScrollBarSliderPosition, 0) / 10.0f;
+                    UpdateAxisSettingsWidgets();
+
+                    return 1;
+                }
+            }
+        }
+
+        for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
+        {
+            AxisBinding *axisBinding = FindAxisBinding(bindingsMode, i);
+            if (axisBinding == NULL)
+                continue;
+
+            for (int j = 0; j < 2; j++)
+            {
+                if (inParam1 == (intptr_t)boundsSliders[i][j])
+                {
+                    // the minimum and the maximum push each other along so that the bounds never cross
+                    const float value = (int)XPGetWidgetProperty(boundsSliders[i][j], xpProperty_ScrollBarSliderPosition, 0) / 100.0f;
+                    if (j == 0)
+                    {
+                        axisBinding->minimum = value;
+                        axisBinding->maximum = fmaxf(axisBinding->maximum, value);
+                    }
+                    else
+                    {
+                        axisBinding->maximum = value;
+                        axisBinding->minimum = fminf(axisBinding->minimum, value);
+                    }
+                    RecompileAxisBindings(bindingsMode, i);
+                    UpdateAxisSettingsWidgets();
+
+                    return 1;
+                }
+            }
+        }
+    }
+    else if (inMessage == xpMsg_TextFieldChanged)
+    {
+        for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
+        {
+            if (inParam1 == (intptr_t)curvePointsTextFields[i])
+            {
+                // the points only take effect once they form a valid curve
+                char text[MAX_CURVE_POINTS_TEXT_LENGTH];
+                XPGetWidgetDescriptor(curvePointsTextFields[i], text, sizeof text);
+                ParseCurvePoints(text, &settings.axisCurves[i]);
+
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void BeginCommand(XPLMCommandRef command)
+{
+    if (!command || FindActiveCommand(command) >= 0)
+        return;
+
+    // a command we cannot track could never be ended again, so we refuse to begin it
+    if (numActiveCommands >= MAX_ACTIVE_COMMANDS)
+    {
+        XPLMDebugString(NAME ": Too many active commands, ignoring command begin\n");
+        return;
+    }
+
+    XPLMCommandBegin(command);
+    TrackCommandPhase(command, xplm_CommandBegin);
+}
+
+static int ButtonIndex(int abstractButtonIndex)
+{
+    switch (settings.controllerType)
+    {
+    case XBOX360:
+        switch (abstractButtonIndex)
+        {
+        case JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT:
+            return JOYSTICK_BUTTON_XBOX360_DPAD_LEFT + settings.buttonOffset;
+        case JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT:
+            return JOYSTICK_BUTTON_XBOX360_DPAD_RIGHT + settings.buttonOffset;
+        case JOYSTICK_BUTTON_ABSTRACT_DPAD_UP:
+            return JOYSTICK_BUTTON_XBOX360_DPAD_UP + settings.buttonOffset;
+        case JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN:
+            return JOYSTICK_BUTTON_XBOX360_DPAD_DOWN + settings.buttonOffset;
+        case JOYSTICK_BUTTON_ABSTRACT_FACE_LEFT:
+            return JOYSTICK_BUTTON_XBOX360_X + settings.buttonOffset;
+        case JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT:
+            return JOYSTICK_BUTTON_XBOX360_B + settings.buttonOffset;
+        case JOYSTICK_BUTTON_ABSTRACT_FACE_UP:
             return JOYSTICK_BUTTON_XBOX360_Y + settings.buttonOffset;
         case JOYSTICK_BUTTON_ABSTRACT_FACE_DOWN:
             return JOYSTICK_BUTTON_XBOX360_A + settings.buttonOffset;
@@ -1359,6 +2428,117 @@ static int ButtonIndex(int abstractButtonIndex)
     }
 }
 
+static int CalibrateAxes(float *joystickAxisValues, float nullzone, float elapsedTime)
+{
+    DeviceCalibration *deviceCalibration = GetDeviceCalibration();
+
+    int numLiveAxes = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        const int axisIndex = AxisIndex(i);
+        if (axisIndex < 0)
+            continue;
+
+        const float value = joystickAxisValues[axisIndex];
+        AxisCalibrationState *state = &axisCalibrationStates[i];
+        AxisCalibration *axis = &deviceCalibration->axes[i];
+
+        // we keep an axis centered until it is live
+        if (!UpdateAxisLiveness(state, value))
+        {
+            joystickAxisValues[axisIndex] = 0.5f;
+            continue;
+        }
+        numLiveAxes++;
+
+        // if the axis has been resting inside the inner deadzone around the current center for a while, the average value during that rest period becomes the new center - a deliberate small deflection that is held steady lies outside of the deadzone and must not be learned as the center
+        const DeadzoneConfig *deadzoneConfig = &settings.stickDeadzones[i / 2];
+        const float maxCenterDrift = 0.5f * (deadzoneConfig->inner < 0.0f ? 2.0f * nullzone : deadzoneConfig->inner);
+        if (fabsf(value - state->restAnchor) > CALIBRATION_REST_TOLERANCE)
+        {
+            state->restAnchor = value;
+            state->restSum = 0.0f;
+            state->restSamples = 0;
+            state->restTime = 0.0f;
+        }
+        else
+        {
+            state->restSum += value;
+            state->restSamples++;
+            state->restTime += elapsedTime;
+
+            if (state->restTime >= CALIBRATION_REST_DURATION)
+            {
+                const float restValue = state->restSum / state->restSamples;
+                if (fabsf(restValue - axis->center) < maxCenterDrift && fabsf(restValue - 0.5f) < CALIBRATION_MAX_CENTER_OFFSET && !FloatsEqual(restValue, axis->center))
+                {
+                    axis->center = restValue;
+                    calibrationChanged = 1;
+                }
+
+                state->restSum = 0.0f;
+                state->restSamples = 0;
+                state->restTime = 0.0f;
+            }
+        }
+
+        // widen the extents as the axis travels further than ever before
+        if (value < axis->minimum)
+        {
+            axis->minimum = value;
+            calibrationChanged = 1;
+        }
+        if (value > axis->maximum)
+        {
+            axis->maximum = value;
+            calibrationChanged = 1;
+        }
+
+        // rescale both halves of the axis so that the learned center maps to 0.5 and the learned extents map to 0.0 and 1.0 - as long as an extent hasn't been explored far enough the nominal extent is used instead
+        float calibratedValue;
+        if (value >= axis->center)
+        {
+            const float extent = axis->maximum - axis->center;
+            calibratedValue = 0.5f + 0.5f * (value - axis->center) / (extent < CALIBRATION_MIN_EXTENT ? 1.0f - axis->center : extent);
+        }
+        else
+        {
+            const float extent = axis->center - axis->minimum;
+            calibratedValue = 0.5f - 0.5f * (axis->center - value) / (extent < CALIBRATION_MIN_EXTENT ? axis->center : extent);
+        }
+
+        joystickAxisValues[axisIndex] = calibratedValue < 0.0f ? 0.0f : (calibratedValue > 1.0f ? 1.0f : calibratedValue);
+    }
+
+    return numLiveAxes > 0;
+}
+
+static int CanPushModeLayer(Mode m)
+{
+    if (numModeLayers == MAX_MODE_LAYERS || IsModeActive(m))
+        return 0;
+
+    // keyboard and mouse control take over the whole controller, so they can only be entered from the default mode and nothing can be layered on top of them
+    if (m == KEYBOARD || m == MOUSE)
+        return numModeLayers == 0;
+
+    return !IsModeActive(KEYBOARD) && !IsModeActive(MOUSE);
+}
+
+static void ClaimDispatchButtons(void)
+{
+    // the buttons that we dispatch ourselves must not trigger anything on X-Plane's side, so the whole window is claimed at once and what its buttons were assigned to before is remembered
+    dispatchWindowStart = modeOverlayTable.buttonWindowStart;
+    dispatchWindowCount = modeOverlayTable.buttonWindowCount;
+    XPLMGetDatavi(joystickButtonAssignmentsDataRef, dispatchSavedAssignments, dispatchWindowStart, dispatchWindowCount);
+
+    int assignments[MAX_DISPATCH_BUTTONS];
+    const int noneCommand = (intptr_t)GetCommand(COMMAND_NONE);
+    for (int i = 0; i < dispatchWindowCount; i++)
+        assignments[i] = noneCommand;
+    XPLMSetDatavi(joystickButtonAssignmentsDataRef, assignments, dispatchWindowStart, dispatchWindowCount);
+}
+
 #if !LIN
 // hid device thread cleanup function
 static void CleanupDeviceThread(hid_device *handle, struct hid_device_info *dev)
@@ -1382,46 +2562,242 @@ static void CleanupShader(GLuint program, GLuint fragmentShader, int deleteProgr
         glDeleteProgram(program);
 }
 
-static int CowlFlapModifierCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
+static void ClearWriteCache(void)
 {
-    ToggleMode(COWL, inPhase);
-
-    return 0;
+    writeCacheSize = 0;
 }
 
-static int CwsOrDisconnectAutopilotCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
+static void CompileAxisBindings(void)
 {
-    if (inPhase == xplm_CommandContinue)
-        return 0;
+    memset(compiledAxisBindings, 0, sizeof compiledAxisBindings);
+
+    const int numAxisBindings = settings.numAxisBindings < MAX_AXIS_BINDINGS ? settings.numAxisBindings : MAX_AXIS_BINDINGS;
+    for (int i = 0; i < numAxisBindings; i++)
+    {
+        const AxisBinding *axisBinding = &settings.axisBindings[i];
+
+        // the bindings come from the settings file, so we skip everything that is out of range
+        if (axisBinding->axis < 0 || axisBinding->axis >= NUM_ABSTRACT_AXES || axisBinding->mode < DEFAULT || axisBinding->mode >= NUM_MODES || axisBinding->actuator < ACTUATOR_POWER || axisBinding->actuator >= NUM_ACTUATORS || axisBinding->curve < 0 || axisBinding->curve >= NUM_ABSTRACT_AXES)
+            continue;
+
+        // helicopters have no prop lever, their prop mode drives the power instead
+        Actuator actuator = axisBinding->actuator;
+        if (actuator == ACTUATOR_PROP && aircraftProfile.helicopter)
+            actuator = ACTUATOR_POWER;
+
+        // power is the collective of a helicopter outside of any mode, the speedbrake of a glider and the throttle of everything else
+        if (actuator == ACTUATOR_POWER)
+        {
+            if (aircraftProfile.helicopter && axisBinding->mode == DEFAULT)
+                actuator = ACTUATOR_COLLECTIVE;
+            else if (aircraftProfile.gliderWithSpeedbrakes)
+                actuator = ACTUATOR_SPEEDBRAKE;
+            else
+                actuator = ACTUATOR_THROTTLE;
+        }
+
+        CompiledAxisBinding *compiledAxisBinding = &compiledAxisBindings[axisBinding->mode][axisBinding->axis];
+        compiledAxisBinding->handler = actuatorHandlers[actuator];
+        compiledAxisBinding->responseCurve = &axisResponseCurves[axisBinding->curve];
+        compiledAxisBinding->rate = axisBinding->rate;
+        if (axisBinding->boundsSource == BOUNDS_CUSTOM)
+        {
+            compiledAxisBinding->minimum = axisBinding->minimum;
+            compiledAxisBinding->maximum = axisBinding->maximum;
+        }
+        else
+        {
+            compiledAxisBinding->minimum = 0.0f;
+            compiledAxisBinding->maximum = 1.0f;
+        }
+    }
+}
+
+static void ConditionAxes(const float *joystickAxisValues, const float *triggerValues, float nullzone, float elapsedTime, int filtered, ConditionedAxes *conditionedAxes)
+{
+    // gather the smoothed stick axes of the active controller and the deadzone parameters of their sticks into packed arrays
+    float rawValues[4], radial[4], inner[4], antiDeadzone[4], inverseRange[4];
+    for (int i = 0; i < 4; i++)
+    {
+        // axes that are unknown for the active controller stay centered
+        const int axisIndex = AxisIndex(i);
+        const float value = axisIndex >= 0 ? joystickAxisValues[axisIndex] : 0.5f;
+
+        // axes that have already been smoothed by the input thread bypass our filter, which starts over once it is needed again
+        if (filtered)
+        {
+            axisFilterStates[i].initialized = 0;
+            rawValues[i] = value;
+        }
+        else
+            rawValues[i] = ApplyOneEuroFilter(&axisFilterStates[i], &settings.axisFilters[i], value, elapsedTime);
+
+        // a negative inner deadzone means that X-Plane's nullzone is used and a negative anti-deadzone means that the output starts right at the inner deadzone
+        const DeadzoneConfig *deadzoneConfig = &settings.stickDeadzones[i / 2];
+        radial[i] = deadzoneConfig->type == DEADZONE_RADIAL ? 1.0f : 0.0f;
+        inner[i] = deadzoneConfig->inner < 0.0f ? 2.0f * nullzone : deadzoneConfig->inner;
+        antiDeadzone[i] = deadzoneConfig->antiDeadzone < 0.0f ? inner[i] : deadzoneConfig->antiDeadzone;
+        const float range = deadzoneConfig->outer - inner[i];
+        inverseRange[i] = 1.0f / (range > FLT_EPSILON ? range : FLT_EPSILON);
+    }
+
+    // center the values around 0.0, then rescale the magnitude of each axis (axial) or each stick (radial) from [inner, outer] to [antiDeadzone, 1.0] and zero everything within the inner deadzone
+#if USE_SSE
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 centered = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(rawValues), _mm_set1_ps(0.5f)), _mm_set1_ps(2.0f));
+    const __m128 squares = _mm_mul_ps(centered, centered);
+    const __m128 stickMagnitudes = _mm_sqrt_ps(_mm_add_ps(squares, _mm_shuffle_ps(squares, squares, _MM_SHUFFLE(2, 3, 0, 1))));
+    const __m128 axisMagnitudes = _mm_andnot_ps(_mm_set1_ps(-0.0f), centered);
+    const __m128 radialMask = _mm_cmpgt_ps(_mm_loadu_ps(radial), zero);
+    const __m128 magnitudes = _mm_or_ps(_mm_and_ps(radialMask, stickMagnitudes), _mm_andnot_ps(radialMask, axisMagnitudes));
+    const __m128 innerValues = _mm_loadu_ps(inner);
+    const __m128 antiDeadzoneValues = _mm_loadu_ps(antiDeadzone);
+    const __m128 t = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(magnitudes, innerValues), _mm_loadu_ps(inverseRange)), one);
+    const __m128 remapped = _mm_add_ps(antiDeadzoneValues, _mm_mul_ps(t, _mm_sub_ps(one, antiDeadzoneValues)));
+    const __m128 scaled = _mm_mul_ps(centered, _mm_div_ps(remapped, _mm_max_ps(magnitudes, _mm_set1_ps(FLT_EPSILON))));
+    const __m128 clamped = _mm_max_ps(_mm_min_ps(scaled, one), _mm_set1_ps(-1.0f));
+    _mm_storeu_ps(conditionedAxes->deflections, _mm_and_ps(clamped, _mm_cmpgt_ps(magnitudes, innerValues)));
+#else
+    for (int i = 0; i < 4; i++)
+    {
+        const float centered = (rawValues[i] - 0.5f) * 2.0f;
+        const float other = (rawValues[i ^ 1] - 0.5f) * 2.0f;
+        const float magnitude = radial[i] > 0.0f ? sqrtf(centered * centered + other * other) : fabsf(centered);
+
+        if (magnitude > inner[i])
+        {
+            float t = (magnitude - inner[i]) * inverseRange[i];
+            t = t < 1.0f ? t : 1.0f;
+
+            const float scaled = centered * (antiDeadzone[i] + t * (1.0f - antiDeadzone[i])) / (magnitude > FLT_EPSILON ? magnitude : FLT_EPSILON);
+            conditionedAxes->deflections[i] = scaled < -1.0f ? -1.0f : (scaled > 1.0f ? 1.0f : scaled);
+        }
+        else
+            conditionedAxes->deflections[i] = 0.0f;
+    }
+#endif
+
+    // the triggers only have a single direction, anything below the threshold counts as released
+    for (int i = JOYSTICK_AXIS_ABSTRACT_LEFT_TRIGGER; i <= JOYSTICK_AXIS_ABSTRACT_RIGHT_TRIGGER; i++)
+    {
+        const float triggerValue = triggerValues[i - JOYSTICK_AXIS_ABSTRACT_LEFT_TRIGGER];
+        conditionedAxes->deflections[i] = triggerValue > TRIGGER_THRESHOLD ? Normalize(triggerValue, TRIGGER_THRESHOLD, 1.0f, 0.0f, 1.0f) : 0.0f;
+    }
+
+    // apply the response curve of each axis and restore the sign
+    for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
+    {
+        const float deflection = conditionedAxes->deflections[i];
+        conditionedAxes->values[i] = copysignf(EvaluateResponseCurve(&axisResponseCurves[i], fabsf(deflection)), deflection);
+    }
+}
+
+inline static int CountTrailingZeros(uint64_t bits)
+{
+    // only defined for bits != 0
+#if IBM
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return (int)index;
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+static int CowlFlapModifierCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
+{
+    ToggleMode(COWL, inPhase);
+
+    return 0;
+}
+
+static XPWidgetID CreateSlider(int left, int top, int right, int bottom, int min, int max)
+{
+    XPWidgetID slider = XPCreateWidget(left, top, right, bottom, 1, "", 0, axisSettingsWidget, xpWidgetClass_ScrollBar);
+    XPSetWidgetProperty(slider, xpProperty_ScrollBarType, xpScrollBarTypeSlider);
+    XPSetWidgetProperty(slider, xpProperty_ScrollBarMin, min);
+    XPSetWidgetProperty(slider, xpProperty_ScrollBarMax, max);
+    XPSetWidgetProperty(slider, xpProperty_ScrollBarPageAmount, 1);
+
+    return slider;
+}
+
+static float CurveValue(const CurveConfig *curveConfig, float x)
+{
+    switch (curveConfig->type)
+    {
+    case CURVE_QUADRATIC:
+        return x * x;
+    case CURVE_CUBIC:
+        return x * x * x;
+    case CURVE_S:
+        return x * x * (3.0f - 2.0f * x);
+    case CURVE_CUSTOM:
+    {
+        // user-defined curves are given as points with ascending x values that get connected linearly
+        const int numPoints = curveConfig->numPoints < MAX_RESPONSE_CURVE_POINTS ? curveConfig->numPoints : MAX_RESPONSE_CURVE_POINTS;
+        if (numPoints < 2)
+            return x;
+
+        const float(*points)[2] = curveConfig->points;
+        if (x <= points[0][0])
+            return points[0][1];
+
+        for (int i = 1; i < numPoints; i++)
+        {
+            if (x <= points[i][0])
+            {
+                const float width = points[i][0] - points[i - 1][0];
+                if (width <= 0.0f)
+                    return points[i][1];
+
+                return points[i - 1][1] + (points[i][1] - points[i - 1][1]) * (x - points[i - 1][0]) / width;
+            }
+        }
+
+        return points[numPoints - 1][1];
+    }
+    default:
+        return x;
+    }
+}
+
+static int CwsOrDisconnectAutopilotCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
+{
+    TrackCommandPhase(inCommand, inPhase);
+
+    if (inPhase == xplm_CommandContinue)
+        return 0;
 
     XPLMCommandRef command = NULL;
     switch (XPLMGetDatai(preconfiguredApTypeDataRef))
     {
     case 0:
         // custom handling for autopilot disconnect command
-        if (IsPluginEnabled(TOLISS_PLUGIN_SIGNATURE))
+        if (IsPluginEnabled(PLUGIN_TOLISS))
         {
-            command = XPLMFindCommand("sim/autopilot/Flight-Dir Down");
+            command = GetCommand(COMMAND_AUTOPILOT_FLIGHT_DIR_DOWN);
             break;
         }
-        else if (IsPluginEnabled(ZIBO_PLUGIN_SIGNATURE))
+        else if (IsPluginEnabled(PLUGIN_ZIBO))
         {
-            command = XPLMFindCommand("laminar/B738/autopilot/capt_disco_press");
+            command = GetCommand(COMMAND_B738_CAPT_DISCO_PRESS);
             break;
         }
     case 1:
         // otherwise fallback to the default command
-        command = XPLMFindCommand("sim/autopilot/servos_off_any");
+        command = GetCommand(COMMAND_AUTOPILOT_SERVOS_OFF_ANY);
         break;
     default:
-        command = XPLMFindCommand("sim/autopilot/control_wheel_steer");
+        command = GetCommand(COMMAND_AUTOPILOT_CONTROL_WHEEL_STEER);
         break;
     }
 
     if (inPhase == xplm_CommandBegin)
-        XPLMCommandBegin(command);
+        BeginCommand(command);
     else
-        XPLMCommandEnd(command);
+        EndCommand(command);
 
     return 0;
 }
@@ -1464,6 +2840,10 @@ static void *DeviceThread(void *argument)
         int down1 = data[35] >> 7 == 0;
         int down2 = data[39] >> 7 == 0;
 
+        // let the flight loop know that the touchpad is in use
+        if (down1 || touchpadButtonDown)
+            hidDeviceThreadActive = 1;
+
         int x1 = data[36] + (data[37] & 0xF) * 255;
         int y1 = ((data[37] & 0xF0) >> 4) + data[38] * 16;
         int dX1 = x1 - prevX1;
@@ -1520,44 +2900,59 @@ static void *DeviceThread(void *argument)
 }
 #endif
 
-static void DrawIndicatorsWindow(XPLMWindowID inWindowID, void *inRefcon)
+static int DispatchButtons(void)
 {
-    const int gliderWithSpeedbrakes = IsGliderWithSpeedbrakes();
-    const int helicopter = IsHelicopter();
+    if (dispatchWindowCount <= 0)
+        return 0;
 
-    XPLMSetGraphicsState(0, 0, 0, 0, 1, 0, 0);
+    int joystickButtonValues[MAX_DISPATCH_BUTTONS];
+    XPLMGetDatavi(joystickButtonValuesDataRef, joystickButtonValues, dispatchWindowStart, dispatchWindowCount);
 
-    glUseProgram(indicatorsProgram);
+    // the whole window fits into a single word, so only the buttons that changed since the last frame are visited
+    uint64_t buttonStates;
+    PackButtonValues(joystickButtonValues, dispatchWindowCount, &buttonStates);
+    uint64_t changedButtons = buttonStates ^ dispatchButtonStates;
+    dispatchButtonStates = buttonStates;
 
-    float throttle = 0.0f;
-    if (gliderWithSpeedbrakes)
-        throttle = 1.0f - XPLMGetDataf(speedbrakeRatioDataRef);
-    else
-        throttle = GetThrottleRatio(throttleBetaRevRatioAllDataRef);
-
-    const int throttleLocation = glGetUniformLocation(indicatorsProgram, "throttle");
-    glUniform1f(throttleLocation, throttle);
+    // the flight loop only has to keep running every frame while a dispatched button is held down or has just changed
+    const int active = buttonStates || changedButtons;
 
-    const int propLocation = glGetUniformLocation(indicatorsProgram, "prop");
-    float propRatio = 0.0f;
-    if (helicopter)
+    while (changedButtons)
     {
-        float acfMinPitch = 0.0f;
-        XPLMGetDatavf(acfMinPitchDataRef, &acfMinPitch, 0, 1);
-        float acfMaxPitch = 0.0f;
-        XPLMGetDatavf(acfMaxPitchDataRef, &acfMaxPitch, 0, 1);
-        float propPitchDeg = 0.0f;
-        XPLMGetDatavf(propPitchDegDataRef, &propPitchDeg, 0, 1);
+        const int i = CountTrailingZeros(changedButtons);
+        changedButtons &= changedButtons - 1;
 
-        propRatio = Normalize(propPitchDeg, acfMinPitch, acfMaxPitch, 0.0f, 1.0f);
+        // the command is remembered on press so that it is ended even if the mode changed while the button was held down
+        if ((buttonStates >> i) & 1)
+        {
+            dispatchedCommands[i] = ResolveButtonCommand(dispatchWindowStart + i);
+            BeginCommand(dispatchedCommands[i]);
+        }
+        else
+        {
+            EndCommand(dispatchedCommands[i]);
+            dispatchedCommands[i] = NULL;
+        }
     }
-    else
-        propRatio = Normalize(XPLMGetDataf(propRotationSpeedRadSecAllDataRef), XPLMGetDataf(acfFeatheredPitchDataRef), XPLMGetDataf(acfRSCRedlinePrpDataRef), 0.0f, 1.0f);
 
-    glUniform1f(propLocation, numPropLevers < 1 ? -3.0f : propRatio);
+    return active;
+}
+
+static void DrawIndicatorsWindow(XPLMWindowID inWindowID, void *inRefcon)
+{
+    XPLMSetGraphicsState(0, 0, 0, 0, 1, 0, 0);
+
+    glUseProgram(indicatorsProgram);
+
+    // the indicator values are prepared by the housekeeping flight loop, so we don't need to read any datarefs while drawing
+    const int throttleLocation = glGetUniformLocation(indicatorsProgram, "throttle");
+    glUniform1f(throttleLocation, indicatorValues.throttle);
+
+    const int propLocation = glGetUniformLocation(indicatorsProgram, "prop");
+    glUniform1f(propLocation, indicatorValues.prop);
 
     const int mixtureLocation = glGetUniformLocation(indicatorsProgram, "mixture");
-    glUniform1f(mixtureLocation, numMixtureLevers < 1 ? -3.0f : XPLMGetDataf(mixtureRatioAllDataRef));
+    glUniform1f(mixtureLocation, indicatorValues.mixture);
 
     int left, top, right, bottom;
     XPLMGetWindowGeometry(indicatorsWindow, &left, &top, &right, &bottom);
@@ -1676,23 +3071,85 @@ static void DrawKeyboardWindow(XPLMWindowID inWindowID, void *inRefcon)
     glUseProgram(0);
 }
 
+static void EndCommand(XPLMCommandRef command)
+{
+    // only end commands that are actually active, otherwise their handlers would be called needlessly
+    if (!command || FindActiveCommand(command) < 0)
+        return;
+
+    XPLMCommandEnd(command);
+    TrackCommandPhase(command, xplm_CommandEnd);
+}
+
 static void EndKeyboardMode(void)
 {
     ReleaseAllKeys();
 
-    // restore the default button assignments
-    PopButtonAssignments();
+    // restore the assignments that were overridden by the keyboard mode
+    PopModeLayer(KEYBOARD);
 
     if (keyboardWindow)
         XPLMSetWindowIsVisible(keyboardWindow, 0);
+}
+
+inline static float EvaluateResponseCurve(const ResponseCurve *responseCurve, float x)
+{
+    if (x <= 0.0f)
+        return responseCurve->table[0];
+    if (x >= 1.0f)
+        return responseCurve->table[RESPONSE_CURVE_TABLE_SIZE];
+
+    // linearly interpolate between the two closest table entries
+    const float position = x * RESPONSE_CURVE_TABLE_SIZE;
+    const int index = (int)position;
+    const float fraction = position - index;
 
-    mode = DEFAULT;
+    return responseCurve->table[index] + (responseCurve->table[index + 1] - responseCurve->table[index]) * fraction;
 }
 
-static float Exponentialize(float value, float inMin, float inMax, float outMin, float outMax)
+static int FindActiveCommand(XPLMCommandRef command)
 {
-    float n = Normalize(value, inMin, inMax, 0.0f, 1.0f);
-    return Normalize(powf(n * 100.0f, JOYSTICK_RELATIVE_CONTROL_EXPONENT), 0.0f, powf(100.0f, JOYSTICK_RELATIVE_CONTROL_EXPONENT), outMin, outMax);
+    for (int i = 0; i < numActiveCommands; i++)
+    {
+        if (activeCommands[i] == command)
+            return i;
+    }
+
+    return -1;
+}
+
+static AxisBinding *FindAxisBinding(Mode m, int abstractAxisIndex)
+{
+    const int numAxisBindings = settings.numAxisBindings < MAX_AXIS_BINDINGS ? settings.numAxisBindings : MAX_AXIS_BINDINGS;
+    for (int i = 0; i < numAxisBindings; i++)
+    {
+        if (settings.axisBindings[i].mode == m && settings.axisBindings[i].axis == abstractAxisIndex)
+            return &settings.axisBindings[i];
+    }
+
+    return NULL;
+}
+
+static int FindModeLayer(Mode m)
+{
+    for (int i = 0; i < numModeLayers; i++)
+    {
+        if (modeLayers[i].mode == m)
+            return i;
+    }
+
+    return -1;
+}
+
+static AssignmentOverlayEntry *FindOverlayEntry(AssignmentOverlay *overlay, int index)
+{
+    for (int i = 0; i < overlay->numEntries; i++)
+    {
+        if (overlay->entries[i].index == index)
+            return &overlay->entries[i];
+    }
+
+    return NULL;
 }
 
 static void FitGeometryWithinScreenBounds(int *left, int *top, int *right, int *bottom)
@@ -1729,14 +3186,467 @@ static void FitGeometryWithinScreenBounds(int *left, int *top, int *right, int *
     }
 }
 
-static float FlightLoopCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon)
-{
-    const float currentTime = XPLMGetElapsedTime();
+inline static int FloatsEqual(float a, float b)
+{
+    return fabs(a - b) < FLT_EPSILON;
+}
+
+static void FormatCurvePoints(const CurveConfig *curveConfig, char *text, size_t size)
+{
+    // a curve without enough points is shown as the straight line that it evaluates to
+    const int numPoints = curveConfig->numPoints < MAX_RESPONSE_CURVE_POINTS ? curveConfig->numPoints : MAX_RESPONSE_CURVE_POINTS;
+    if (numPoints < 2)
+    {
+        snprintf(text, size, "0.00,0.00 1.00,1.00");
+        return;
+    }
+
+    size_t length = 0;
+    text[0] = '\0';
+    for (int i = 0; i < numPoints && length < size; i++)
+        length += snprintf(text + length, size - length, i > 0 ? " %.2f,%.2f" : "%.2f,%.2f", curveConfig->points[i][0], curveConfig->points[i][1]);
+}
+
+static XPLMCommandRef GetCommand(CommandId commandId)
+{
+    // commands of third-party aircraft only exist once the aircraft's plugin has been loaded, so we retry looking them up until they are found
+    if (!commandRefs[commandId])
+        commandRefs[commandId] = XPLMFindCommand(commandNames[commandId]);
+
+    return commandRefs[commandId];
+}
+
+static int GetDefaultAxisAssignment(int abstractAxisIndex)
+{
+    // the axes that drive an actuator outside of any mode must not control anything else
+    if (compiledAxisBindings[DEFAULT][abstractAxisIndex].handler)
+        return AXIS_ASSIGNMENT_NONE;
+
+    switch (abstractAxisIndex)
+    {
+    case JOYSTICK_AXIS_ABSTRACT_LEFT_X:
+        return AXIS_ASSIGNMENT_YAW;
+    case JOYSTICK_AXIS_ABSTRACT_RIGHT_X:
+        return AXIS_ASSIGNMENT_ROLL;
+    case JOYSTICK_AXIS_ABSTRACT_RIGHT_Y:
+        return AXIS_ASSIGNMENT_PITCH;
+    // the triggers of a DualShock 4 controller are X-Plane's toe brakes, those of an Xbox 360 controller brake through UpdateTriggers
+    case JOYSTICK_AXIS_ABSTRACT_LEFT_TRIGGER:
+        return settings.controllerType == DS4 ? AXIS_ASSIGNMENT_LEFT_TOE_BRAKE : AXIS_ASSIGNMENT_NONE;
+    case JOYSTICK_AXIS_ABSTRACT_RIGHT_TRIGGER:
+        return settings.controllerType == DS4 ? AXIS_ASSIGNMENT_RIGHT_TOE_BRAKE : AXIS_ASSIGNMENT_NONE;
+    default:
+        return AXIS_ASSIGNMENT_NONE;
+    }
+}
+
+static DeviceCalibration *GetDeviceCalibration(void)
+{
+    if (deviceCalibrationIndex >= 0 && deviceCalibrations[deviceCalibrationIndex].controllerType == settings.controllerType && deviceCalibrations[deviceCalibrationIndex].axisOffset == settings.axisOffset)
+        return &deviceCalibrations[deviceCalibrationIndex];
+
+    // a different device is in use, its axes have to report a valid value again before we trust them
+    memset(axisCalibrationStates, 0, sizeof axisCalibrationStates);
+    memset(triggerCalibrationStates, 0, sizeof triggerCalibrationStates);
+
+    for (deviceCalibrationIndex = 0; deviceCalibrationIndex < numDeviceCalibrations; deviceCalibrationIndex++)
+    {
+        if (deviceCalibrations[deviceCalibrationIndex].controllerType == settings.controllerType && deviceCalibrations[deviceCalibrationIndex].axisOffset == settings.axisOffset)
+            return &deviceCalibrations[deviceCalibrationIndex];
+    }
+
+    // start with a nominal calibration for an unknown device - once all slots are taken the last one gets recycled
+    if (numDeviceCalibrations < MAX_CALIBRATED_DEVICES)
+        numDeviceCalibrations++;
+    deviceCalibrationIndex = numDeviceCalibrations - 1;
+
+    DeviceCalibration *deviceCalibration = &deviceCalibrations[deviceCalibrationIndex];
+    deviceCalibration->controllerType = settings.controllerType;
+    deviceCalibration->axisOffset = settings.axisOffset;
+    for (int i = 0; i < 4; i++)
+    {
+        deviceCalibration->axes[i].center = 0.5f;
+        deviceCalibration->axes[i].minimum = 0.5f;
+        deviceCalibration->axes[i].maximum = 0.5f;
+    }
+
+    return deviceCalibration;
+}
+
+static float GetThrottleRatio(XPLMDataRef fallbackThrottleRatioDataRef)
+{
+    float throttRatio;
+
+    const XPLMDataRef airbusThrottleInputDataRef = thirdPartyDataRefs[THIRD_PARTY_DATAREF_AIRBUS_THROTTLE_INPUT];
+    if (airbusThrottleInputDataRef)
+        XPLMGetDatavf(airbusThrottleInputDataRef, &throttRatio, 4, 1);
+    else
+        throttRatio = XPLMGetDataf(fallbackThrottleRatioDataRef);
+
+    return throttRatio;
+}
+
+inline static int GetKeyboardWidth(void)
+{
+    return KEY_BASE_SIZE * 17 + (int)(KEY_BASE_SIZE * 2.5f);
+}
+
+static XPLMCursorStatus HandleCursor(XPLMWindowID inWindowID, int x, int y, void *inRefcon)
+{
+    return xplm_CursorArrow;
+}
+
+static void HandleKey(XPLMWindowID inWindowID, char inKeyboardKey, XPLMKeyFlags inFlags, char inVirtualKeyboardKey, void *inRefcon, int losingFocus)
+{
+}
+
+static void HandleKeyboardSelectorCommand(XPLMCommandPhase inPhase, KeyboardKey *newSelectedKey)
+{
+    if (keyPressActive)
+        return;
+
+    static float lastSelectorMovementTime = 0.0f;
+    const float currentTime = XPLMGetElapsedTime();
+
+    if (inPhase == xplm_CommandBegin || (inPhase == xplm_CommandContinue && currentTime - lastSelectorMovementTime > KEY_SELECTOR_MOVEMENT_MIN_ELAPSE_TIME))
+    {
+        selectedKey = newSelectedKey;
+        lastSelectorMovementTime = currentTime;
+    }
+}
+
+static int HandleMouseClick(XPLMWindowID inWindowID, int x, int y, XPLMMouseStatus inMouse, void *inRefcon)
+{
+    if (XPLMGetDatai(vrEnabledDataRef))
+        return 0;
+
+    static int lastX = -1, lastY = -1;
+
+    switch (inMouse)
+    {
+    case xplm_MouseDrag:
+        if (lastX > 0 && lastY > 0)
+        {
+            int *right, *bottom;
+            if (inWindowID == indicatorsWindow)
+            {
+                right = &settings.indicatorsRight;
+                bottom = &settings.indicatorsBottom;
+            }
+            else if (inWindowID == keyboardWindow)
+            {
+                right = &settings.keyboardRight;
+                bottom = &settings.keyboardBottom;
+            }
+            else
+                return 0;
+
+            int left = 0, top = 0;
+            XPLMGetWindowGeometry(inWindowID, &left, &top, right, bottom);
+
+            int deltaX = x - lastX;
+            int deltaY = y - lastY;
+
+            left += deltaX;
+            top += deltaY;
+            *right += deltaX;
+            *bottom += deltaY;
+
+            FitGeometryWithinScreenBounds(&left, &top, right, bottom);
+            XPLMSetWindowGeometry(inWindowID, left, top, *right, *bottom);
+        }
+    case xplm_MouseDown:
+        lastX = x;
+        lastY = y;
+        break;
+    case xplm_MouseUp:
+        lastX = lastY = -1;
+        SaveSettings();
+        break;
+    default:
+        break;
+    }
+
+    return 1;
+}
+
+static int HandleMouseWheel(XPLMWindowID inWindowID, int x, int y, int wheel, int clicks, void *inRefcon)
+{
+    return 0;
+}
+
+static void HandleScrollCommand(XPLMCommandPhase phase, int clicks)
+{
+    static float lastScrollTime = 0.0f;
+    float currentTime = XPLMGetElapsedTime();
+
+    if (phase == xplm_CommandBegin || currentTime - lastScrollTime >= 0.1f)
+    {
+#if LIN
+        Scroll(clicks, display);
+#else
+        Scroll(clicks, NULL);
+#endif
+        lastScrollTime = currentTime;
+    }
+}
+
+static void HandleToggleMouseButtonCommand(XPLMCommandPhase phase, MouseButton button)
+{
+    if (phase != xplm_CommandContinue)
+#if LIN
+        ToggleMouseButton(button, phase == xplm_CommandBegin, display);
+#else
+        ToggleMouseButton(button, phase == xplm_CommandBegin, NULL);
+#endif
+}
+
+static int Has2DPanel(void)
+{
+    char fileName[256], path[512];
+    XPLMGetNthAircraftModel(0, fileName, path);
+
+    int has2DPanel = 1;
+
+    // search the '.acf' file for a special string which indicates that the aircraft shows the 3D cockpit object in the 2D forward panel view
+    FILE *file = fopen(path, "r");
+    if (file)
+    {
+        char temp[512];
+        while (fgets(temp, 512, file))
+        {
+            if ((strstr(temp, ACF_STRING_SHOW_COCKPIT_OBJECT_IN_2D_FORWARD_PANEL_VIEWS)))
+            {
+                has2DPanel = 0;
+                break;
+            }
+        }
+
+        fclose(file);
+    }
+    return has2DPanel;
+}
+
+static float HousekeepingFlightLoopCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon)
+{
+    const float currentTime = XPLMGetElapsedTime();
+
+    UpdateFrameState();
+
+    // there is no notification when other plugins get enabled or disabled, so we recheck them periodically
+    static float lastPluginCheckTime = 0.0f;
+    if (thirdPartyDataRefsStale || currentTime - lastPluginCheckTime >= PLUGIN_CHECK_INTERVAL)
+    {
+        lastPluginCheckTime = currentTime;
+        UpdateEnabledPlugins();
+    }
+
+    // the modifier overlays depend on the controller profile and the enabled plugins, they are only rebuilt if either of them changed
+    UpdateModeOverlays();
+    UpdateButtonDispatch();
+
+    if (settings.showIndicators && !XPLMGetWindowIsVisible(indicatorsWindow))
+    {
+        // showIndicators is enabled but the indicators window is not visible (this can happen in VR if the user presses the close button)
+        settings.showIndicators = 0;
+        XPSetWidgetProperty(showIndicatorsCheckbox, xpProperty_ButtonState, settings.showIndicators);
+    }
+
+    if (XPLMGetWindowIsVisible(keyboardWindow))
+    {
+        SyncLockKeyState(&captialKeyboardKey);
+#if !APL
+        SyncLockKeyState(&numLockKeyboardKey);
+        SyncLockKeyState(&scrollKeyboardKey);
+#endif
+    }
+    else if (mode == KEYBOARD)
+        // we are in keyboard mode but the keyboard window is not visible (this can happen in VR if the user presses the close button)
+        EndKeyboardMode();
+
+    // update the default head position when required
+    if (FloatsEqual(defaultHeadPositionX, FLT_MAX) || FloatsEqual(defaultHeadPositionY, FLT_MAX) || FloatsEqual(defaultHeadPositionZ, FLT_MAX))
+    {
+        defaultHeadPositionX = XPLMGetDataf(acfPeXDataRef);
+        defaultHeadPositionY = XPLMGetDataf(acfPeYDataRef);
+        defaultHeadPositionZ = XPLMGetDataf(acfPeZDataRef);
+    }
+
+#if !LIN
+    if (frameState.hasJoystick && settings.controllerType == DS4)
+    {
+        static float lastEnumerationTime = 0.0f;
+        if (hidDeviceThread == 0 && currentTime - lastEnumerationTime >= 5.0f)
+        {
+            lastEnumerationTime = currentTime;
+
+            if (!hidInitialized && hid_init() != -1)
+                hidInitialized = 1;
+
+            if (hidInitialized)
+            {
+                struct hid_device_info *devs = hid_enumerate(0x0, 0x0);
+                struct hid_device_info *currentDev = devs;
+
+                while (currentDev)
+                {
+                    if (currentDev->vendor_id == 0x54C && (currentDev->product_id == 0x5C4 || currentDev->product_id == 0x9CC || currentDev->product_id == 0xBA0))
+                    {
+                        struct hid_device_info *currentDevCopy = (struct hid_device_info *)calloc(1, sizeof(struct hid_device_info));
+                        currentDevCopy->vendor_id = currentDev->vendor_id;
+                        currentDevCopy->product_id = currentDev->product_id;
+
+#if IBM
+                        HANDLE threadHandle = (HANDLE)_beginthread(DeviceThread, 0, currentDevCopy);
+                        if (threadHandle)
+                        {
+                            hidDeviceThread = threadHandle;
+                            break;
+                        }
+#elif APL
+                        if (pthread_create(&hidDeviceThread, NULL, DeviceThread, currentDevCopy))
+                            break;
+#endif
+                        else
+                            hid_free_enumeration(currentDevCopy);
+                    }
+
+                    currentDev = currentDev->next;
+                }
+
+                hid_free_enumeration(devs);
+            }
+        }
+    }
+#else
+    UpdateInputThreadConfig();
+
+    if (settings.directInput && frameState.hasJoystick && !inputThreadRunning)
+    {
+        static float lastEnumerationTime = 0.0f;
+        if (currentTime - lastEnumerationTime >= EVDEV_ENUMERATION_INTERVAL)
+        {
+            lastEnumerationTime = currentTime;
+
+            // reap the thread of a device that has been disconnected before looking for a new one
+            if (inputThreadStarted)
+            {
+                pthread_join(inputThread, NULL);
+                inputThreadStarted = 0;
+            }
+
+            const int fd = OpenEvdevDevice();
+            if (fd != -1)
+            {
+                inputThreadRunning = 1;
+                if (pthread_create(&inputThread, NULL, InputThread, (void *)(intptr_t)fd) == 0)
+                    inputThreadStarted = 1;
+                else
+                {
+                    inputThreadRunning = 0;
+                    close(fd);
+                }
+            }
+        }
+    }
+#endif
+
+    const int indicatorsWindowVisible = indicatorsWindow && XPLMGetWindowIsVisible(indicatorsWindow);
+    if (indicatorsWindowVisible)
+        UpdateIndicatorValues();
+
+    // the indicators and the lock key states only need to be refreshed every frame while their windows are visible
+    return indicatorsWindowVisible || XPLMGetWindowIsVisible(keyboardWindow) ? -1.0f : IDLE_FLIGHT_LOOP_INTERVAL;
+}
+
+static KeyboardKey InitKeyboardKey(const char *label, int keyCode, float aspect, KeyPosition position)
+{
+    const int width = (int)(KEY_BASE_SIZE * aspect);
+    const int labelOffsetX = (int)XPLMMeasureString(xplmFont_Basic, label, strlen(label)) / 2;
+
+    KeyboardKey key = {strdup(label), keyCode, aspect, width, labelOffsetX, position, UP, 0.0f, NULL, NULL, NULL, NULL};
+    return key;
+}
+
+static void InitShader(const char *fragmentShaderString, GLuint *program, GLuint *fragmentShader)
+{
+    *program = glCreateProgram();
+
+    *fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(*fragmentShader, 1, &fragmentShaderString, 0);
+    glCompileShader(*fragmentShader);
+    glAttachShader(*program, *fragmentShader);
+    GLint isFragmentShaderCompiled = GL_FALSE;
+    glGetShaderiv(*fragmentShader, GL_COMPILE_STATUS, &isFragmentShaderCompiled);
+    if (isFragmentShaderCompiled == GL_FALSE)
+    {
+        GLsizei maxLength = 2048;
+        GLchar *log = calloc(maxLength, sizeof(GLchar));
+        glGetShaderInfoLog(*fragmentShader, maxLength, &maxLength, log);
+        XPLMDebugString(NAME ": The following error occured while compiling a fragment shader:\n");
+        XPLMDebugString(log);
+        free(log);
+
+        CleanupShader(*program, *fragmentShader, 1);
+
+        return;
+    }
+
+    glLinkProgram(*program);
+    GLint isProgramLinked = GL_FALSE;
+    glGetProgramiv(*program, GL_LINK_STATUS, &isProgramLinked);
+    if (isProgramLinked == GL_FALSE)
+    {
+        GLsizei maxLength = 2048;
+        GLchar *log = calloc(maxLength, sizeof(GLchar));
+        glGetShaderInfoLog(*program, maxLength, &maxLength, log);
+        XPLMDebugString(NAME ": The following error occured while linking a shader program:\n");
+        XPLMDebugString(log);
+        free(log);
+
+        CleanupShader(*program, *fragmentShader, 1);
+
+        return;
+    }
+
+    CleanupShader(*program, *fragmentShader, 0);
+}
+
+static float InputFlightLoopCallback(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon)
+{
+    const float currentTime = XPLMGetElapsedTime();
+
+    // while idling the time since the last call spans several frames, so we only account for the last frame once input appears again
+    const float elapsedTime = inputFlightLoopIdle ? inElapsedTimeSinceLastFlightLoop : inElapsedSinceLastCall;
+    inputFlightLoopIdle = 0;
+
+    // the input flight loop only needs to run every frame while there is input to process, otherwise it falls back to a slower rate
+    int inputActive = mode != DEFAULT || numActiveCommands > 0 || configurationStep == AXES || configurationStep == BUTTONS || configurationStep == ABORT;
+
+#if !LIN
+    if (hidDeviceThreadActive)
+    {
+        hidDeviceThreadActive = 0;
+        inputActive = 1;
+    }
+#endif
+
+    UpdateFrameState();
+
+    if (thirdPartyDataRefsStale)
+        ResolveThirdPartyDataRefs();
+
+    for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
+        UpdateResponseCurve(&axisResponseCurves[i], &settings.axisCurves[i]);
+    UpdateResponseCurve(&accelerationResponseCurve, &accelerationCurveConfig);
 
     KeyboardKey **ptr = keyboardKeys;
     KeyboardKey **endPtr = keyboardKeys + sizeof(keyboardKeys) / sizeof(keyboardKeys[0]);
     while (ptr < endPtr)
     {
+        if ((**ptr).state != UP)
+            inputActive = 1;
+
         switch ((**ptr).state)
         {
         case NEW_UP:
@@ -1765,42 +3675,10 @@ static float FlightLoopCallback(float inElapsedSinceLastCall, float inElapsedTim
         ptr++;
     }
 
-    if (settings.showIndicators && !XPLMGetWindowIsVisible(indicatorsWindow))
-    {
-        // showIndicators is enabled but the indicators window is not visible (this can happen in VR if the user presses the close button)
-        settings.showIndicators = 0;
-        XPSetWidgetProperty(showIndicatorsCheckbox, xpProperty_ButtonState, settings.showIndicators);
-    }
-
-    if (XPLMGetWindowIsVisible(keyboardWindow))
-    {
-        SyncLockKeyState(&captialKeyboardKey);
-#if !APL
-        SyncLockKeyState(&numLockKeyboardKey);
-        SyncLockKeyState(&scrollKeyboardKey);
-#endif
-    }
-    else if (mode == KEYBOARD)
-        // we are in keyboard mode but the keyboard window is not visible (this can happen in VR if the user presses the close button)
-        EndKeyboardMode();
-
-    // update the default head position when required
-    if (FloatsEqual(defaultHeadPositionX, FLT_MAX) || FloatsEqual(defaultHeadPositionY, FLT_MAX) || FloatsEqual(defaultHeadPositionZ, FLT_MAX))
-    {
-        defaultHeadPositionX = XPLMGetDataf(acfPeXDataRef);
-        defaultHeadPositionY = XPLMGetDataf(acfPeYDataRef);
-        defaultHeadPositionZ = XPLMGetDataf(acfPeZDataRef);
-    }
-
-    const int helicopter = IsHelicopter();
-
-    int currentMouseX, currentMouseY;
-    XPLMGetMouseLocation(&currentMouseX, &currentMouseY);
-
     // handle switch to 3D command look
     if (switchTo3DCommandLook)
     {
-        XPLMCommandOnce(XPLMFindCommand("sim/view/3d_cockpit_cmnd_look"));
+        XPLMCommandOnce(GetCommand(COMMAND_VIEW_3D_COCKPIT_COMMAND_LOOK));
         switchTo3DCommandLook = 0;
     }
 
@@ -1808,125 +3686,81 @@ static float FlightLoopCallback(float inElapsedSinceLastCall, float inElapsedTim
     if (thrustReverserMode && GetThrottleRatio(throttleBetaRevRatioAllDataRef) > 0.0f)
         thrustReverserMode = 0;
 
-    if (XPLMGetDatai(hasJoystickDataRef))
+    if (frameState.hasJoystick)
     {
+        float triggerValues[2] = {0.0f, 0.0f};
+
 #if IBM
         if (settings.controllerType == XBOX360)
         {
             XINPUT_STATE xinputState;
             XInputGetState(settings.xinputUserIndex, &xinputState);
 
-            static Mode prevMode = DEFAULT;
-            static int prevLeftTriggerDown = 0, prevRightTriggerDown = 0;
-            const int leftTriggerDown = xinputState.Gamepad.bLeftTrigger > XINPUT_GAMEPAD_TRIGGER_THRESHOLD;
-            const int rightTriggerDown = xinputState.Gamepad.bRightTrigger > XINPUT_GAMEPAD_TRIGGER_THRESHOLD;
-
-            float leftBrakeRatio = 0.0f, rightBrakeRatio = 0.0f;
-
-            if (mode == LOOK)
-            {
-                if (leftTriggerDown && !prevLeftTriggerDown)
-                    XPLMCommandBegin(pushToTalkCommand);
-                else if (!leftTriggerDown && prevLeftTriggerDown)
-                    XPLMCommandEnd(pushToTalkCommand);
-
-                if (rightTriggerDown && !prevRightTriggerDown)
-                    XPLMCommandBegin(cwsOrDisconnectAutopilotCommand);
-                else if (!rightTriggerDown && prevRightTriggerDown)
-                    XPLMCommandEnd(cwsOrDisconnectAutopilotCommand);
-            }
-            else
-            {
-                if (mode != prevMode)
-                {
-                    if (prevLeftTriggerDown)
-                        XPLMCommandEnd(pushToTalkCommand);
-                    if (prevRightTriggerDown)
-                        XPLMCommandEnd(cwsOrDisconnectAutopilotCommand);
-                }
-                leftBrakeRatio = leftTriggerDown ? Normalize((float) xinputState.Gamepad.bLeftTrigger, (float) XINPUT_GAMEPAD_TRIGGER_THRESHOLD, 255.0f, 0.0f, 1.0f) : 0.0f;
-                rightBrakeRatio = rightTriggerDown ? Normalize((float) xinputState.Gamepad.bRightTrigger, (float) XINPUT_GAMEPAD_TRIGGER_THRESHOLD, 255.0f, 0.0f, 1.0f) : 0.0f;
-            }
-
-            XPLMSetDataf(leftBrakeRatioDataRef, leftBrakeRatio);
-            XPLMSetDataf(rightBrakeRatioDataRef, rightBrakeRatio);
-
-            prevMode = mode;
-            prevLeftTriggerDown = leftTriggerDown;
-            prevRightTriggerDown = rightTriggerDown;
+            triggerValues[0] = xinputState.Gamepad.bLeftTrigger / 255.0f;
+            triggerValues[1] = xinputState.Gamepad.bRightTrigger / 255.0f;
 
             static int prevGuideButtonDown = 0;
             const int guideButtonDown = xinputState.Gamepad.wButtons & 0x400;
 
+            if (guideButtonDown)
+                inputActive = 1;
+
             if (!prevGuideButtonDown && guideButtonDown)
             {
                 prevGuideButtonDown = 1;
-                XPLMCommandBegin(toggleMousePointerControlCommand);
+                BeginCommand(toggleMousePointerControlCommand);
             }
             else if (prevGuideButtonDown && !guideButtonDown)
             {
                 prevGuideButtonDown = 0;
-                XPLMCommandEnd(toggleMousePointerControlCommand);
+                EndCommand(toggleMousePointerControlCommand);
             }
         }
 #endif
 
-#if !LIN
-        if (settings.controllerType == DS4)
+        // outside of the configuration we only fetch the axes that we actually evaluate
+        float joystickAxisValues[100];
+        if (configurationStep == AXES)
+            XPLMGetDatavf(joystickAxisValuesDataRef, joystickAxisValues, 0, 100);
+        else
         {
-            static float lastEnumerationTime = 0.0f;
-            if (hidDeviceThread == 0 && currentTime - lastEnumerationTime >= 5.0f)
-            {
-                lastEnumerationTime = currentTime;
-
-                if (!hidInitialized && hid_init() != -1)
-                    hidInitialized = 1;
-
-                if (hidInitialized)
-                {
-                    struct hid_device_info *devs = hid_enumerate(0x0, 0x0);
-                    struct hid_device_info *currentDev = devs;
-
-                    while (currentDev)
-                    {
-                        if (currentDev->vendor_id == 0x54C && (currentDev->product_id == 0x5C4 || currentDev->product_id == 0x9CC || currentDev->product_id == 0xBA0))
-                        {
-                            struct hid_device_info *currentDevCopy = (struct hid_device_info *)calloc(1, sizeof(struct hid_device_info));
-                            currentDevCopy->vendor_id = currentDev->vendor_id;
-                            currentDevCopy->product_id = currentDev->product_id;
-
-#if IBM
-                            HANDLE threadHandle = (HANDLE)_beginthread(DeviceThread, 0, currentDevCopy);
-                            if (threadHandle)
-                            {
-                                hidDeviceThread = threadHandle;
-                                break;
-                            }
-#elif APL
-                            if (pthread_create(&hidDeviceThread, NULL, DeviceThread, currentDevCopy))
-                                break;
-#endif
-                            else
-                                hid_free_enumeration(currentDevCopy);
-                        }
-
-                        currentDev = currentDev->next;
-                    }
+            UpdateReadPlan();
+            XPLMGetDatavf(joystickAxisValuesDataRef, joystickAxisValues + readPlan.axisStart, readPlan.axisStart, readPlan.axisCount);
+        }
 
-                    hid_free_enumeration(devs);
-                }
+#if LIN
+        // when the input thread reads the controller, its already filtered stick and trigger axes take the place of what X-Plane sampled during the last frame
+        const ControllerState *controllerState = settings.directInput && configurationStep != AXES ? AcquireControllerState() : NULL;
+        if (controllerState)
+        {
+            for (int i = CONTROLLER_AXIS_LEFT_X; i < NUM_CONTROLLER_AXES; i++)
+            {
+                const int axisIndex = AxisIndex(i);
+                if (axisIndex >= 0)
+                    joystickAxisValues[axisIndex] = controllerState->axisValues[i];
             }
+
+            if (controllerState->buttons || controllerState->pressedButtons || controllerState->releasedButtons)
+                inputActive = 1;
         }
+        const int axesFiltered = controllerState != NULL;
+#else
+        const int axesFiltered = 0;
 #endif
 
-        float joystickAxisValues[100];
-        XPLMGetDatavf(joystickAxisValuesDataRef, joystickAxisValues, 0, 100);
+        // except for the xinput triggers of an xbox controller the analog triggers are regular axes, which are treated as released until they are live so that an untouched trigger cannot apply the brakes or drive an actuator
+        for (int i = 0; i < 2; i++)
+        {
+            const int axisIndex = AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_TRIGGER + i);
+            if (axisIndex >= 0 && UpdateAxisLiveness(&triggerCalibrationStates[i], joystickAxisValues[axisIndex]))
+                triggerValues[i] = joystickAxisValues[axisIndex];
+        }
 
-        int joystickButtonValues[1600];
-        XPLMGetDatavi(joystickButtonValuesDataRef, joystickButtonValues, 0, 1600);
+        if (settings.controllerType == XBOX360 && UpdateTriggers(triggerValues[0], triggerValues[1]))
+            inputActive = 1;
 
         static int potentialAxes[100] = {0};
-        static int potentialButtons[1600] = {0};
+        static uint64_t potentialButtons[BUTTON_BITSET_WORDS] = {0};
 
 #if IBM
         static XINPUT_STATE initialXinputStates[4] = {0};
@@ -1954,6 +3788,7 @@ static float FlightLoopCallback(float inElapsedSinceLastCall, float inElapsedTim
             }
             return -1.0f;
         case BUTTONS:
+        {
 #if IBM
             // in order to obtain the xinput user index we go through all states and compare them with the initial state
             if (settings.controllerType == XBOX360)
@@ -1969,14 +3804,21 @@ static float FlightLoopCallback(float inElapsedSinceLastCall, float inElapsedTim
                 }
 #endif
 
-            // because some joysticks have buttons that are in a depressed state by default, we go through all buttons and mark the indices of the buttons that are not pressed, if we see a previously marked button getting pressed we can assume it is the button the user pressed
-            for (int i = 0; i < 1600; i++)
+            int joystickButtonValues[NUM_JOYSTICK_BUTTONS];
+            XPLMGetDatavi(joystickButtonValuesDataRef, joystickButtonValues, 0, NUM_JOYSTICK_BUTTONS);
+
+            uint64_t buttonBits[BUTTON_BITSET_WORDS];
+            PackButtonValues(joystickButtonValues, NUM_JOYSTICK_BUTTONS, buttonBits);
+
+            // because some joysticks have buttons that are in a depressed state by default, we go through all buttons and mark the indices of the buttons that are not pressed, if we see a previously marked button getting pressed we can assume it is the button the user pressed - the buttons are compared 64 at a time
+            for (int i = 0; i < BUTTON_BITSET_WORDS; i++)
             {
-                if (joystickButtonValues[i])
-                    potentialButtons[i] = 1;
-                else if (potentialButtons[i])
+                const uint64_t changedButtons = potentialButtons[i] & ~buttonBits[i];
+                potentialButtons[i] |= buttonBits[i];
+
+                if (changedButtons)
                 {
-                    settings.buttonOffset = i - (XBOX360 ? JOYSTICK_BUTTON_XBOX360_X : JOYSTICK_BUTTON_DS4_CROSS);
+                    settings.buttonOffset = i * 64 + CountTrailingZeros(changedButtons) - (XBOX360 ? JOYSTICK_BUTTON_XBOX360_X : JOYSTICK_BUTTON_DS4_CROSS);
                     SetDefaultAssignments();
                     SaveSettings();
                     memset(potentialButtons, 0, sizeof potentialButtons);
@@ -1986,6 +3828,7 @@ static float FlightLoopCallback(float inElapsedSinceLastCall, float inElapsedTim
                 }
             }
             return -1.0f;
+        }
         case ABORT:
             // we need to cleanup the arrays in case of an abort
             memset(potentialAxes, 0, sizeof potentialAxes);
@@ -1998,656 +3841,282 @@ static float FlightLoopCallback(float inElapsedSinceLastCall, float inElapsedTim
             break;
         }
 
-        const float sensitivityMultiplier = JOYSTICK_RELATIVE_CONTROL_MULTIPLIER * inElapsedSinceLastCall;
-
-        const float joystickPitchNullzone = XPLMGetDataf(joystickPitchNullzoneDataRef);
-
-        static int joystickAxisLeftXCalibrated = 0;
-        if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)] > 0.0f)
-            joystickAxisLeftXCalibrated = 1;
-
-        // keep the value of the left joystick's y axis at 0.5 until a value higher/lower than 0.0/1.0 is read because axis can get initialized with a value of 0.0 or 1.0 instead of 0.5 if they haven't been moved yet - this can result in unexpected behaviour especially if the axis is used in relative mode
-        static float leftJoystickMinYValue = 1.0f, leftJoystickMaxYValue = 0.0f;
-
-        if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] < leftJoystickMinYValue)
-            leftJoystickMinYValue = joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)];
-
-        if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] > leftJoystickMaxYValue)
-            leftJoystickMaxYValue = joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)];
-
-        if (FloatsEqual(leftJoystickMinYValue, 1.0f) || FloatsEqual(leftJoystickMaxYValue, 0.0f))
-            joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] = 0.5f;
-
-        if (joystickAxisLeftXCalibrated)
-        {
-            const int acfNumEngines = XPLMGetDatai(acfNumEnginesDataRef);
-
-            if (mode == LOOK)
-            {
-                XPLMCommandEnd(XPLMFindCommand("sim/autopilot/servos_off_any"));
-
-                const int viewType = XPLMGetDatai(viewTypeDataRef);
-
-                if (viewType == VIEW_TYPE_3D_COCKPIT_COMMAND_LOOK)
-                {
-                    float deltaPsi = 0.0f, deltaThe = 0.0f;
-                    const float viewSensitivityMultiplier = JOYSTICK_LOOK_SENSITIVITY * inElapsedSinceLastCall;
-
-                    // turn head to the left
-                    if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)] < 0.5f - joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 0.0] to [0.0, 1.0]
-                        const float d = Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)], 0.5f, 0.0f, 0.0f, 1.0f);
-
-                        deltaPsi -= d * viewSensitivityMultiplier;
-                    }
-                    // turn head to the right
-                    else if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)] > 0.5f + joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 1.0] to [0.0, 1.0]
-                        const float d = Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)], 0.5f, 1.0f, 0.0f, 1.0f);
-
-                        deltaPsi += d * viewSensitivityMultiplier;
-                    }
-
-                    // turn head upward
-                    if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] < 0.5f - joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 0.0] to [0.0, 1.0]
-                        const float d = Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 0.0f, 0.0f, 1.0f);
-
-                        deltaThe += d * viewSensitivityMultiplier;
-                    }
-                    // turn head downward
-                    else if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] > 0.5f + joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 1.0] to [0.0, 1.0]
-                        const float d = Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 1.0f, 0.0f, 1.0f);
-
-                        deltaThe -= d * viewSensitivityMultiplier;
-                    }
-
-                    const float pilotsHeadPsi = XPLMGetDataf(pilotsHeadPsiDataRef);
-                    const float pilotsHeadThe = XPLMGetDataf(pilotsHeadTheDataRef);
-
-                    float newPilotsHeadPsi = pilotsHeadPsi + deltaPsi;
-                    float newPilotsHeadThe = pilotsHeadThe + deltaThe;
-
-                    if (newPilotsHeadThe < -89.9f)
-                        newPilotsHeadThe = -89.9f;
-                    if (newPilotsHeadThe > 89.9f)
-                        newPilotsHeadThe = 89.9f;
-
-                    XPLMSetDataf(pilotsHeadPsiDataRef, newPilotsHeadPsi);
-                    XPLMSetDataf(pilotsHeadTheDataRef, newPilotsHeadThe);
-                }
-                else if (viewType == VIEW_TYPE_FORWARDS_WITH_PANEL || viewType == VIEW_TYPE_CHASE)
-                {
-                    // move camera to the left
-                    if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)] < 0.5f - joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 0.0] to [0.0, 1.0]
-                        const float d = Normalize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)], 0.5f, 0.0f, 0.0f, 1.0f);
-
-                        // apply acceleration function (y = x^2) and round to integer
-                        const int n = (int)(powf(2.0f * d, 2.0f) + 0.5f);
-
-                        // apply the command
-                        for (int i = 0; i < n; i++)
-                            XPLMCommandOnce(XPLMFindCommand("sim/general/left"));
-                    }
-                    // move camera to the right
-                    else if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)] > 0.5f + joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 1.0] to [0.0, 1.0]
-                        const float d = Normalize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)], 0.5f, 1.0f, 0.0f, 1.0f);
-
-                        // apply acceleration function (y = x^2) and round to integer
-                        const int n = (int)(powf(2.0f * d, 2.0f) + 0.5f);
-
-                        // apply the command
-                        for (int i = 0; i < n; i++)
-                            XPLMCommandOnce(XPLMFindCommand("sim/general/right"));
-                    }
-
-                    // move camera up
-                    if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] < 0.5f - joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 0.0] to [0.0, 1.0]
-                        const float d = Normalize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 0.0f, 0.0f, 1.0f);
-
-                        // apply acceleration function (y = x^2) and round to integer
-                        const int n = (int)(powf(2.0f * d, 2.0f) + 0.5f);
-
-                        // apply the command
-                        for (int i = 0; i < n; i++)
-                            XPLMCommandOnce(XPLMFindCommand("sim/general/up"));
-                    }
-                    // move camera down
-                    else if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] > 0.5f + joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 1.0] to [0.0, 1.0]
-                        const float d = Normalize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 1.0f, 0.0f, 1.0f);
-
-                        // apply acceleration function (y = x^2) and round to integer
-                        const int n = (int)(powf(2.0f * d, 2.0f) + 0.5f);
-
-                        // apply the command
-                        for (int i = 0; i < n; i++)
-                            XPLMCommandOnce(XPLMFindCommand("sim/general/down"));
-                    }
-                }
-            }
-            else
-            {
-                XPLMCommandEnd(pushToTalkCommand);
-
-                if (!helicopter && mode == PROP)
-                {
-                    const float acfFeatheredPitch = XPLMGetDataf(acfFeatheredPitchDataRef);
-                    const float acfRSCRedlinePrp = XPLMGetDataf(acfRSCRedlinePrpDataRef);
-                    const float propRotationSpeedRadSecAll = XPLMGetDataf(propRotationSpeedRadSecAllDataRef);
-
-                    // increase prop pitch
-                    if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] < 0.5f - joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 0.0] to [acfFeatheredPitch, acfRSCRedlinePrp]
-                        const float d = sensitivityMultiplier * Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 0.0f, acfFeatheredPitch, acfRSCRedlinePrp);
-
-                        const float newPropRotationSpeedRadSecAll = propRotationSpeedRadSecAll + d;
-
-                        // ensure we don't set values larger than redline
-                        XPLMSetDataf(propRotationSpeedRadSecAllDataRef, newPropRotationSpeedRadSecAll < acfRSCRedlinePrp ? newPropRotationSpeedRadSecAll : acfRSCRedlinePrp);
-                    }
-                    // decrease prop pitch
-                    else if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] > 0.5f + joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 1.0] to [acfFeatheredPitch, acfRSCRedlinePrp]
-                        const float d = sensitivityMultiplier * Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 1.0f, acfFeatheredPitch, acfRSCRedlinePrp);
-
-                        const float newPropRotationSpeedRadSecAll = propRotationSpeedRadSecAll - d;
-
-                        // ensure we don't set values smaller than feathered pitch
-                        XPLMSetDataf(propRotationSpeedRadSecAllDataRef, newPropRotationSpeedRadSecAll > acfFeatheredPitch ? newPropRotationSpeedRadSecAll : acfFeatheredPitch);
-                    }
-                }
-                else if (mode == MIXTURE)
-                {
-                    const float mixtureRatioAll = XPLMGetDataf(mixtureRatioAllDataRef);
-
-                    // increase mixture setting
-                    if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] < 0.5f - joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 0.0] to [0.0, 1.0]
-                        const float d = sensitivityMultiplier * Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 0.0f, 0.0f, 1.0f);
-
-                        const float newMixtureRatioAll = mixtureRatioAll + d;
-
-                        // ensure we don't set values larger than 1.0
-                        XPLMSetDataf(mixtureRatioAllDataRef, newMixtureRatioAll < 1.0f ? newMixtureRatioAll : 1.0f);
-                    }
-                    // decrease mixture setting
-                    else if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] > 0.5f + joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 1.0] to [0.0, 1.0]
-                        const float d = sensitivityMultiplier * Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 1.0f, 0.0f, 1.0f);
-
-                        const float newMixtureRatioAll = mixtureRatioAll - d;
-
-                        // ensure we don't set values smaller than 0.0
-                        XPLMSetDataf(mixtureRatioAllDataRef, newMixtureRatioAll > 0.0f ? newMixtureRatioAll : 0.0f);
-                    }
-                }
-                else if (mode == COWL)
-                {
-                    float cowlFlapRatio[8];
-                    XPLMGetDatavf(cowlFlapRatioDataRef, cowlFlapRatio, 0, acfNumEngines);
-
-                    // decrease cowl flap setting
-                    if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] < 0.5f - joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 0.0] to [0.0, 1.0]
-                        const float d = sensitivityMultiplier * Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 0.0f, 0.0f, 1.0f);
-
-                        // ensure we don't set values smaller than 0.0
-                        for (int i = 0; i < acfNumEngines; i++)
-                        {
-                            const float newCowlFlapRatio = cowlFlapRatio[i] - d;
-                            cowlFlapRatio[i] = newCowlFlapRatio > 0.0f ? newCowlFlapRatio : 0.0f;
-                        }
-                    }
-                    // increase cowl flap setting
-                    else if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] > 0.5f + joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 1.0] to [0.0, 1.0]
-                        const float d = sensitivityMultiplier * Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 1.0f, 0.0f, 1.0f);
-
-                        // ensure we don't set values larger than 1.0
-                        for (int i = 0; i < acfNumEngines; i++)
-                        {
-                            const float newCowlFlapRatio = cowlFlapRatio[i] + d;
-                            cowlFlapRatio[i] = newCowlFlapRatio < 1.0f ? newCowlFlapRatio : 1.0f;
-                        }
-                    }
-
-                    XPLMSetDatavf(cowlFlapRatioDataRef, cowlFlapRatio, 0, acfNumEngines);
-                }
-                else if (mode == MOUSE)
-                {
-                    int distX = 0, distY = 0;
-
-                    // move mouse pointer left
-                    if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)] < 0.5f - joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 0.0] to [0.0, 1.0]
-                        const float d = Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)], 0.5f, 0.0f, 0.0f, 1.0f);
-
-                        // apply acceleration function (y = x^2)
-                        distX -= (int)(powf(d * JOYSTICK_MOUSE_POINTER_SENSITIVITY, 2.0f) * inElapsedSinceLastCall);
-                    }
-                    // move mouse pointer right
-                    else if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)] > 0.5f + joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 1.0] to [0.0, 1.0]
-                        const float d = Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)], 0.5f, 1.0f, 0.0f, 1.0f);
-
-                        // apply acceleration function (y = x^2)
-                        distX += (int)(powf(d * JOYSTICK_MOUSE_POINTER_SENSITIVITY, 2.0f) * inElapsedSinceLastCall);
-                    }
-
-                    // move mouse pointer up
-                    if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] < 0.5f - joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 0.0] to [0.0, 1.0]
-                        const float d = Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 0.0f, 0.0f, 1.0f);
-
-                        // apply acceleration function (y = x^2)
-                        distY -= (int)(powf(d * JOYSTICK_MOUSE_POINTER_SENSITIVITY, 2.0f) * inElapsedSinceLastCall);
-                    }
-                    // move mouse pointer down
-                    else if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] > 0.5f + joystickPitchNullzone)
-                    {
-                        // normalize range [0.5, 1.0] to [0.0, 1.0]
-                        const float d = Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 1.0f, 0.0f, 1.0f);
-
-                        // apply acceleration function (y = x^2)
-                        distY += (int)(powf(d * JOYSTICK_MOUSE_POINTER_SENSITIVITY, 2.0f) * inElapsedSinceLastCall);
-                    }
-
-                    // handle mouse pointer movement
-#if LIN
-                    MoveMousePointer(distX, distY, display);
-#else
-                    MoveMousePointer(distX, distY, NULL);
-#endif
-                }
-                else
-                {
-                    if (helicopter && mode == DEFAULT)
-                    {
-                        float acfMinPitch[8];
-                        XPLMGetDatavf(acfMinPitchDataRef, acfMinPitch, 0, 8);
-                        float acfMaxPitch[8];
-                        XPLMGetDatavf(acfMaxPitchDataRef, acfMaxPitch, 0, 8);
-                        float propPitchDeg[8];
-                        XPLMGetDatavf(propPitchDegDataRef, propPitchDeg, 0, acfNumEngines);
-
-                        for (int i = 0; i < acfNumEngines; i++)
-                        {
-                            // increase prop pitch
-                            if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] < 0.5f - joystickPitchNullzone)
-                            {
-                                // normalize range [0.5, 0.0] to [acfMinPitch, acfMaxPitch]
-                                const float d = sensitivityMultiplier * Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 0.0f, acfMinPitch[i], acfMaxPitch[i]);
-
-                                const float newPropPitchDeg = propPitchDeg[i] + d;
-
-                                // ensure we don't set values larger than acfMaxPitch
-                                propPitchDeg[i] = newPropPitchDeg < acfMaxPitch[i] ? newPropPitchDeg : acfMaxPitch[i];
-                            }
-                            // decrease prop pitch
-                            else if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] > 0.5f + joystickPitchNullzone)
-                            {
-                                // normalize range [0.5, 1.0] to [acfMinPitch, acfMaxPitch]
-                                const float d = sensitivityMultiplier * Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 1.0f, acfMinPitch[i], acfMaxPitch[i]);
-
-                                const float newPropPitchDeg = propPitchDeg[i] - d;
-
-                                // ensure we don't set values smaller than acfMinPitch
-                                propPitchDeg[i] = newPropPitchDeg > acfMinPitch[i] ? newPropPitchDeg : acfMinPitch[i];
-                            }
-                        }
-
-                        XPLMSetDatavf(propPitchDegDataRef, propPitchDeg, 0, acfNumEngines);
-                    }
-                    else
-                    {
-                        if (IsGliderWithSpeedbrakes())
-                        {
-                            float speedbrakeRatio = XPLMGetDataf(speedbrakeRatioDataRef);
-
-                            // decrease speedbrake ratio
-                            if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] < 0.5f - joystickPitchNullzone)
-                            {
-                                // de-arm speedbrake if armed
-                                if (FloatsEqual(speedbrakeRatio, -0.5f))
-                                    speedbrakeRatio = 0.0f;
-
-                                // normalize range [0.5, 0.0] to [0.0, 1.0]
-                                const float d = sensitivityMultiplier * Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 0.0f, 0.0f, 1.0f);
-
-                                const float newSpeedbrakeRatio = speedbrakeRatio - d;
-
-                                // ensure we don't set values smaller than 0.0
-                                XPLMSetDataf(speedbrakeRatioDataRef, newSpeedbrakeRatio > 0.0f ? newSpeedbrakeRatio : 0.0f);
-                            }
-                            // increase speedbrake ratio
-                            else if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] > 0.5f + joystickPitchNullzone)
-                            {
-                                // de-arm speedbrake if armed
-                                if (FloatsEqual(speedbrakeRatio, -0.5f))
-                                    speedbrakeRatio = 0.0f;
-
-                                // normalize range [0.5, 1.0] to [0.0, 1.0]
-                                const float d = sensitivityMultiplier * Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 1.0f, 0.0f, 1.0f);
-
-                                const float newSpeedbrakeRatio = speedbrakeRatio + d;
-
-                                // ensure we don't set values larger than 1.0
-                                XPLMSetDataf(speedbrakeRatioDataRef, newSpeedbrakeRatio < 1.0f ? newSpeedbrakeRatio : 1.0f);
-                            }
-                        }
-                        else
-                        {
-                            // increase throttle setting
-                            if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] < 0.5f - joystickPitchNullzone)
-                            {
-                                // normalize range [0.5, 0.0] to [0.0, 1.0]
-                                const float d = sensitivityMultiplier * Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 0.0f, 0.0f, 1.0f);
-
-                                const XPLMDataRef throttleRatioDataRef = GetThrottleRatioDataRef();
-                                float newThrottleRatioAll = GetThrottleRatio(throttleRatioDataRef) + d;
-
-                                // ensure we don't set values larger than 1.0
-                                newThrottleRatioAll = newThrottleRatioAll < 1.0f ? newThrottleRatioAll : 1.0f;
-
-                                XPLMSetDataf(throttleRatioDataRef, newThrottleRatioAll);
-                                SetToLissThrottle(newThrottleRatioAll);
-                            }
-                            // decrease throttle setting
-                            else if (joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] > 0.5f + joystickPitchNullzone)
-                            {
-                                // normalize range [0.5, 1.0] to [0.0, 1.0]
-                                const float d = sensitivityMultiplier * Exponentialize(joystickAxisValues[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)], 0.5f, 1.0f, 0.0f, 1.0f);
-
-                                const XPLMDataRef throttleRatioDataRef = GetThrottleRatioDataRef();
-                                float newThrottleRatioAll = GetThrottleRatio(throttleRatioDataRef) - d;
-
-                                float lowerThrottleBound;
-                                if (thrustReverserMode)
-                                {
-                                    if (throttleRatioDataRef == throttleBetaRevRatioAllDataRef)
-                                        lowerThrottleBound = -2.0f;
-                                    else
-                                        lowerThrottleBound = -1.0f;
-                                }
-                                else
-                                    lowerThrottleBound = 0.0f;
-
-                                // ensure we don't set values smaller than the lower throttle bound
-                                newThrottleRatioAll = newThrottleRatioAll > lowerThrottleBound ? newThrottleRatioAll : lowerThrottleBound;
-
-                                XPLMSetDataf(throttleRatioDataRef, newThrottleRatioAll);
-                                SetToLissThrottle(newThrottleRatioAll);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    return -1.0f;
-}
-
-inline static int FloatsEqual(float a, float b)
-{
-    return fabs(a - b) < FLT_EPSILON;
-}
-
-static float GetThrottleRatio(XPLMDataRef fallbackThrottleRatioDataRef)
-{
-    float throttRatio;
-
-    const XPLMDataRef airbusThrottleInputDataRef = XPLMFindDataRef("AirbusFBW/throttle_input");
-    if (airbusThrottleInputDataRef)
-        XPLMGetDatavf(airbusThrottleInputDataRef, &throttRatio, 4, 1);
-    else
-        throttRatio = XPLMGetDataf(fallbackThrottleRatioDataRef);
-
-    return throttRatio;
-}
-
-static XPLMDataRef GetThrottleRatioDataRef(void)
-{
-    if (XPLMGetDatai(acfHasBetaDataRef))
-        return throttleBetaRevRatioAllDataRef;
-    else if (XPLMGetDatai(acfRevthrustEqDataRef))
-        return throttleJetRevRatioAllDataRef;
-    else
-        return throttleRatioAllDataRef;
-}
-
-inline static int GetKeyboardWidth(void)
-{
-    return KEY_BASE_SIZE * 17 + (int)(KEY_BASE_SIZE * 2.5f);
-}
-
-static XPLMCursorStatus HandleCursor(XPLMWindowID inWindowID, int x, int y, void *inRefcon)
-{
-    return xplm_CursorArrow;
-}
+        // with direct dispatch we poll the buttons ourselves
+        if (DispatchButtons())
+            inputActive = 1;
 
-static void HandleKey(XPLMWindowID inWindowID, char inKeyboardKey, XPLMKeyFlags inFlags, char inVirtualKeyboardKey, void *inRefcon, int losingFocus)
-{
-}
+        // relative controls advance in fixed timesteps so that their rate does not depend on the frame rate and a hitch cannot make them jump
+        const float sensitivityMultiplier = JOYSTICK_RELATIVE_CONTROL_MULTIPLIER * AdvanceIntegrationClock(elapsedTime);
 
-static void HandleKeyboardSelectorCommand(XPLMCommandPhase inPhase, KeyboardKey *newSelectedKey)
-{
-    if (keyPressActive)
-        return;
+        const float joystickPitchNullzone = frameState.joystickPitchNullzone;
 
-    static float lastSelectorMovementTime = 0.0f;
-    const float currentTime = XPLMGetElapsedTime();
+        const int joystickAxesLive = CalibrateAxes(joystickAxisValues, joystickPitchNullzone, elapsedTime);
 
-    if (inPhase == xplm_CommandBegin || (inPhase == xplm_CommandContinue && currentTime - lastSelectorMovementTime > KEY_SELECTOR_MOVEMENT_MIN_ELAPSE_TIME))
-    {
-        selectedKey = newSelectedKey;
-        lastSelectorMovementTime = currentTime;
-    }
-}
+        ConditionedAxes conditionedAxes;
+        ConditionAxes(joystickAxisValues, triggerValues, joystickPitchNullzone, elapsedTime, axesFiltered, &conditionedAxes);
 
-static int HandleMouseClick(XPLMWindowID inWindowID, int x, int y, XPLMMouseStatus inMouse, void *inRefcon)
-{
-    if (XPLMGetDatai(vrEnabledDataRef))
-        return 0;
+        const float leftX = conditionedAxes.values[JOYSTICK_AXIS_ABSTRACT_LEFT_X];
+        const float leftY = conditionedAxes.values[JOYSTICK_AXIS_ABSTRACT_LEFT_Y];
 
-    static int lastX = -1, lastY = -1;
+        if (fabsf(leftX) > 0.0f || fabsf(leftY) > 0.0f)
+            inputActive = 1;
 
-    switch (inMouse)
-    {
-    case xplm_MouseDrag:
-        if (lastX > 0 && lastY > 0)
+        if (joystickAxesLive)
         {
-            int *right, *bottom;
-            if (inWindowID == indicatorsWindow)
-            {
-                right = &settings.indicatorsRight;
-                bottom = &settings.indicatorsBottom;
-            }
-            else if (inWindowID == keyboardWindow)
+            // look stays in effect while other modifiers are layered on top of it
+            if (IsModeActive(LOOK))
             {
-                right = &settings.keyboardRight;
-                bottom = &settings.keyboardBottom;
-            }
-            else
-                return 0;
+                EndCommand(GetCommand(COMMAND_AUTOPILOT_SERVOS_OFF_ANY));
 
-            int left = 0, top = 0;
-            XPLMGetWindowGeometry(inWindowID, &left, &top, right, bottom);
+                const int viewType = frameState.viewType;
 
-            int deltaX = x - lastX;
-            int deltaY = y - lastY;
+                if (viewType == VIEW_TYPE_3D_COCKPIT_COMMAND_LOOK)
+                {
+                    const float viewSensitivityMultiplier = JOYSTICK_LOOK_SENSITIVITY * elapsedTime;
 
-            left += deltaX;
-            top += deltaY;
-            *right += deltaX;
-            *bottom += deltaY;
+                    // turn head to the left / right and upward / downward
+                    const float pilotsHeadPsi = XPLMGetDataf(pilotsHeadPsiDataRef);
+                    const float pilotsHeadThe = XPLMGetDataf(pilotsHeadTheDataRef);
 
-            FitGeometryWithinScreenBounds(&left, &top, right, bottom);
-            XPLMSetWindowGeometry(inWindowID, left, top, *right, *bottom);
-        }
-    case xplm_MouseDown:
-        lastX = x;
-        lastY = y;
-        break;
-    case xplm_MouseUp:
-        lastX = lastY = -1;
-        SaveSettings();
-        break;
-    default:
-        break;
-    }
+                    float newPilotsHeadPsi = pilotsHeadPsi + leftX * viewSensitivityMultiplier;
+                    float newPilotsHeadThe = pilotsHeadThe - leftY * viewSensitivityMultiplier;
 
-    return 1;
-}
+                    if (newPilotsHeadThe < -89.9f)
+                        newPilotsHeadThe = -89.9f;
+                    if (newPilotsHeadThe > 89.9f)
+                        newPilotsHeadThe = 89.9f;
 
-static int HandleMouseWheel(XPLMWindowID inWindowID, int x, int y, int wheel, int clicks, void *inRefcon)
-{
-    return 0;
-}
+                    SetDatafCached(pilotsHeadPsiDataRef, newPilotsHeadPsi);
+                    SetDatafCached(pilotsHeadTheDataRef, newPilotsHeadThe);
+                }
+                else if (viewType == VIEW_TYPE_FORWARDS_WITH_PANEL || viewType == VIEW_TYPE_CHASE)
+                {
+                    // move camera to the left / right and up / down
+                    static const CommandId cameraCommands[2][2] = {{COMMAND_GENERAL_LEFT, COMMAND_GENERAL_RIGHT}, {COMMAND_GENERAL_UP, COMMAND_GENERAL_DOWN}};
+                    for (int i = JOYSTICK_AXIS_ABSTRACT_LEFT_X; i <= JOYSTICK_AXIS_ABSTRACT_LEFT_Y; i++)
+                    {
+                        const float deflection = conditionedAxes.deflections[i];
 
-static void HandleScrollCommand(XPLMCommandPhase phase, int clicks)
-{
-    static float lastScrollTime = 0.0f;
-    float currentTime = XPLMGetElapsedTime();
+                        // apply acceleration function (y = x^2) and round to integer
+                        const int n = (int)(4.0f * EvaluateResponseCurve(&accelerationResponseCurve, fabsf(deflection)) + 0.5f);
 
-    if (phase == xplm_CommandBegin || currentTime - lastScrollTime >= 0.1f)
-    {
+                        // apply the command
+                        const XPLMCommandRef command = GetCommand(cameraCommands[i][deflection > 0.0f]);
+                        for (int j = 0; j < n; j++)
+                            XPLMCommandOnce(command);
+                    }
+                }
+            }
+            else
+            {
+                EndCommand(pushToTalkCommand);
+
+                if (mode == MOUSE)
+                {
+                    // apply acceleration function (y = x^2)
+                    const float mousePointerMultiplier = JOYSTICK_MOUSE_POINTER_SENSITIVITY * JOYSTICK_MOUSE_POINTER_SENSITIVITY * elapsedTime;
+                    const int distX = (int)(copysignf(EvaluateResponseCurve(&accelerationResponseCurve, fabsf(leftX)), leftX) * mousePointerMultiplier);
+                    const int distY = (int)(copysignf(EvaluateResponseCurve(&accelerationResponseCurve, fabsf(leftY)), leftY) * mousePointerMultiplier);
+
+                    // handle mouse pointer movement
 #if LIN
-        Scroll(clicks, display);
+                    MoveMousePointer(distX, distY, display);
 #else
-        Scroll(clicks, NULL);
+                    MoveMousePointer(distX, distY, NULL);
 #endif
-        lastScrollTime = currentTime;
+                }
+
+                // drive the actuators that are bound to the axes in the current mode
+                const CompiledAxisBinding *modeAxisBindings = compiledAxisBindings[mode];
+                for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
+                {
+                    const CompiledAxisBinding *axisBinding = &modeAxisBindings[i];
+                    if (axisBinding->handler)
+                    {
+                        const float deflection = conditionedAxes.deflections[i];
+                        if (fabsf(deflection) > 0.0f)
+                            inputActive = 1;
+
+                        axisBinding->handler(copysignf(EvaluateResponseCurve(axisBinding->responseCurve, fabsf(deflection)), deflection) * axisBinding->rate, sensitivityMultiplier, axisBinding->minimum, axisBinding->maximum);
+                    }
+                }
+            }
+        }
     }
-}
 
-static void HandleToggleMouseButtonCommand(XPLMCommandPhase phase, MouseButton button)
-{
-    if (phase != xplm_CommandContinue)
-#if LIN
-        ToggleMouseButton(button, phase == xplm_CommandBegin, display);
-#else
-        ToggleMouseButton(button, phase == xplm_CommandBegin, NULL);
-#endif
+    inputFlightLoopIdle = !inputActive;
+
+    return inputActive ? -1.0f : IDLE_INPUT_FLIGHT_LOOP_INTERVAL;
 }
 
-static int Has2DPanel(void)
+#if LIN
+static void *InputThread(void *argument)
 {
-    char fileName[256], path[512];
-    XPLMGetNthAircraftModel(0, fileName, path);
+    const int fd = (int)(intptr_t)argument;
 
-    int has2DPanel = 1;
+    const int epollFd = epoll_create1(0);
+    struct epoll_event epollEvent = {0};
+    epollEvent.events = EPOLLIN;
+    epollEvent.data.fd = fd;
+    if (epollFd == -1 || epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &epollEvent) == -1)
+    {
+        if (epollFd != -1)
+            close(epollFd);
+        close(fd);
+        inputThreadRunning = 0;
+        return (void *)1;
+    }
 
-    // search the '.acf' file for a special string which indicates that the aircraft shows the 3D cockpit object in the 2D forward panel view
-    FILE *file = fopen(path, "r");
-    if (file)
+    // fetch the ranges and the current positions of the axes so that we start out with a complete state
+    struct input_absinfo absInfos[NUM_CONTROLLER_AXES];
+    float rawAxisValues[NUM_CONTROLLER_AXES];
+    for (int i = 0; i < NUM_CONTROLLER_AXES; i++)
     {
-        char temp[512];
-        while (fgets(temp, 512, file))
+        if (ioctl(fd, EVIOCGABS(evdevAxisCodes[i]), &absInfos[i]) == -1 || absInfos[i].maximum <= absInfos[i].minimum)
         {
-            if ((strstr(temp, ACF_STRING_SHOW_COCKPIT_OBJECT_IN_2D_FORWARD_PANEL_VIEWS)))
-            {
-                has2DPanel = 0;
-                break;
-            }
+            absInfos[i].minimum = 0;
+            absInfos[i].maximum = 1;
+            absInfos[i].value = 0;
         }
-
-        fclose(file);
+        rawAxisValues[i] = Normalize((float)absInfos[i].value, (float)absInfos[i].minimum, (float)absInfos[i].maximum, 0.0f, 1.0f);
     }
-    return has2DPanel;
-}
 
-static KeyboardKey InitKeyboardKey(const char *label, int keyCode, float aspect, KeyPosition position)
-{
-    const int width = (int)(KEY_BASE_SIZE * aspect);
-    const int labelOffsetX = (int)XPLMMeasureString(xplmFont_Basic, label, strlen(label)) / 2;
+    InputThreadConfig config;
+    unsigned int configVersion = 0;
+    float samplePeriod = 0.0f;
+    int timeout = 0;
+    int configValid = 0;
 
-    KeyboardKey key = {strdup(label), keyCode, aspect, width, labelOffsetX, position, UP, 0.0f, NULL, NULL, NULL, NULL};
-    return key;
-}
+    OneEuroFilter filters[4] = {{0}};
+    ControllerState state = {{0.0f}, 0, 0, 0};
+    unsigned int pressedButtons = 0, releasedButtons = 0;
 
-static void InitShader(const char *fragmentShaderString, GLuint *program, GLuint *fragmentShader)
-{
-    *program = glCreateProgram();
+    // publish the initial state right away, otherwise the last state of a previously connected device would be used until the first sample period has passed
+    for (int i = 0; i < NUM_CONTROLLER_AXES; i++)
+        state.axisValues[i] = rawAxisValues[i];
 
-    *fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(*fragmentShader, 1, &fragmentShaderString, 0);
-    glCompileShader(*fragmentShader);
-    glAttachShader(*program, *fragmentShader);
-    GLint isFragmentShaderCompiled = GL_FALSE;
-    glGetShaderiv(*fragmentShader, GL_COMPILE_STATUS, &isFragmentShaderCompiled);
-    if (isFragmentShaderCompiled == GL_FALSE)
+    unsigned long keyStates[KEY_MAX / (8 * sizeof(unsigned long)) + 1] = {0};
+    const int bitsPerLong = 8 * sizeof(unsigned long);
+    if (ioctl(fd, EVIOCGKEY(sizeof keyStates), keyStates) != -1)
     {
-        GLsizei maxLength = 2048;
-        GLchar *log = calloc(maxLength, sizeof(GLchar));
-        glGetShaderInfoLog(*fragmentShader, maxLength, &maxLength, log);
-        XPLMDebugString(NAME ": The following error occured while compiling a fragment shader:\n");
-        XPLMDebugString(log);
-        free(log);
+        for (int i = 0; i < 32; i++)
+        {
+            if (keyStates[(BTN_GAMEPAD + i) / bitsPerLong] & (1ul << ((BTN_GAMEPAD + i) % bitsPerLong)))
+                state.buttons |= 1u << i;
+        }
+    }
 
-        CleanupShader(*program, *fragmentShader, 1);
+    PublishControllerState(&state);
 
-        return;
-    }
+    struct timespec lastSampleTime;
+    clock_gettime(CLOCK_MONOTONIC, &lastSampleTime);
 
-    glLinkProgram(*program);
-    GLint isProgramLinked = GL_FALSE;
-    glGetProgramiv(*program, GL_LINK_STATUS, &isProgramLinked);
-    if (isProgramLinked == GL_FALSE)
+    int result = 0;
+    struct input_event events[64];
+    while (inputThreadRun)
     {
-        GLsizei maxLength = 2048;
-        GLchar *log = calloc(maxLength, sizeof(GLchar));
-        glGetShaderInfoLog(*program, maxLength, &maxLength, log);
-        XPLMDebugString(NAME ": The following error occured while linking a shader program:\n");
-        XPLMDebugString(log);
-        free(log);
+        // pick up the configuration when we start and whenever the main thread publishes a new one
+        const unsigned int latestConfigVersion = atomic_load_explicit(&inputThreadConfigVersion, memory_order_acquire);
+        if (!configValid || latestConfigVersion != configVersion)
+        {
+            pthread_mutex_lock(&inputThreadConfigMutex);
+            config = inputThreadConfig;
+            pthread_mutex_unlock(&inputThreadConfigMutex);
+            configVersion = latestConfigVersion;
+            configValid = 1;
+
+            const int rate = config.rate < MIN_INPUT_THREAD_RATE ? MIN_INPUT_THREAD_RATE : (config.rate > MAX_INPUT_THREAD_RATE ? MAX_INPUT_THREAD_RATE : config.rate);
+            samplePeriod = 1.0f / rate;
+            timeout = 1000 / rate > 0 ? 1000 / rate : 1;
+        }
 
-        CleanupShader(*program, *fragmentShader, 1);
+        // drain all pending events, but wake up at least once per sample period
+        if (epoll_wait(epollFd, &epollEvent, 1, timeout) > 0)
+        {
+            ssize_t bytesRead;
+            while ((bytesRead = read(fd, events, sizeof events)) >= (ssize_t)sizeof(struct input_event))
+            {
+                const int numEvents = (int)(bytesRead / (ssize_t)sizeof(struct input_event));
+                for (int i = 0; i < numEvents; i++)
+                {
+                    const struct input_event *event = &events[i];
 
-        return;
+                    if (event->type == EV_ABS)
+                    {
+                        for (int j = 0; j < NUM_CONTROLLER_AXES; j++)
+                        {
+                            if (event->code == evdevAxisCodes[j])
+                                rawAxisValues[j] = Normalize((float)event->value, (float)absInfos[j].minimum, (float)absInfos[j].maximum, 0.0f, 1.0f);
+                        }
+                    }
+                    else if (event->type == EV_KEY && event->code >= BTN_GAMEPAD && event->code < BTN_GAMEPAD + 32)
+                    {
+                        const unsigned int button = 1u << (event->code - BTN_GAMEPAD);
+                        if (event->value)
+                        {
+                            state.buttons |= button;
+                            pressedButtons |= button;
+                        }
+                        else
+                        {
+                            state.buttons &= ~button;
+                            releasedButtons |= button;
+                        }
+                    }
+                }
+            }
+
+            if (bytesRead == -1 ? errno != EAGAIN && errno != EINTR : bytesRead >= 0)
+            {
+                // the device is gone, the housekeeping flight loop will look for it again
+                result = 1;
+                break;
+            }
+        }
+
+        struct timespec currentTime;
+        clock_gettime(CLOCK_MONOTONIC, &currentTime);
+        const float elapsedTime = (float)(currentTime.tv_sec - lastSampleTime.tv_sec) + (float)(currentTime.tv_nsec - lastSampleTime.tv_nsec) * 1e-9f;
+        if (elapsedTime < samplePeriod)
+            continue;
+        lastSampleTime = currentTime;
+
+        // smoothing the sticks at the sampling rate instead of the frame rate lets the filter follow fast movements more closely
+        for (int i = 0; i < NUM_CONTROLLER_AXES; i++)
+            state.axisValues[i] = i <= CONTROLLER_AXIS_RIGHT_Y ? ApplyOneEuroFilter(&filters[i], &config.axisFilters[i], rawAxisValues[i], elapsedTime) : rawAxisValues[i];
+
+        if (pressedButtons)
+            atomic_fetch_or_explicit(&controllerPressedButtons, pressedButtons, memory_order_relaxed);
+        if (releasedButtons)
+            atomic_fetch_or_explicit(&controllerReleasedButtons, releasedButtons, memory_order_relaxed);
+        pressedButtons = 0;
+        releasedButtons = 0;
+
+        PublishControllerState(&state);
     }
 
-    CleanupShader(*program, *fragmentShader, 0);
-}
+    close(epollFd);
+    close(fd);
+    inputThreadRunning = 0;
 
-inline static int IsGliderWithSpeedbrakes(void)
-{
-    return XPLMGetDatai(acfNumEnginesDataRef) < 1 && XPLMGetDatai(acfSbrkEQDataRef);
+    return (void *)(intptr_t)result;
 }
+#endif
 
-static int IsHelicopter(void)
+inline static int IntegrateDeflection(float deflection, float rate, float min, float max, float *value)
 {
-    if (XPLMGetDatai(acfCockpitTypeDataRef) == 5)
+    // move the value into the direction of the deflection but only clamp it to the bound it is moving towards
+    if (deflection > 0.0f)
+    {
+        const float newValue = *value + deflection * rate;
+        *value = newValue < max ? newValue : max;
         return 1;
-
-    int acfPropType[8];
-    XPLMGetDatavi(acfPropTypeDataRef, acfPropType, 0, 8);
-    for (int i = 0; i < XPLMGetDatai(acfNumEnginesDataRef); i++)
+    }
+    else if (deflection < 0.0f)
     {
-        if (acfPropType[i] == 3)
-            return 1;
+        const float newValue = *value + deflection * rate;
+        *value = newValue > min ? newValue : min;
+        return 1;
     }
 
     return 0;
@@ -2662,11 +4131,14 @@ inline static int IsLockKey(KeyboardKey keyboardKey)
 #endif
 }
 
-static int IsPluginEnabled(const char *pluginSignature)
+inline static int IsModeActive(Mode m)
 {
-    XPLMPluginID pluginId = XPLMFindPluginBySignature(pluginSignature);
+    return FindModeLayer(m) >= 0;
+}
 
-    return XPLMIsPluginEnabled(pluginId);
+inline static int IsPluginEnabled(PluginId pluginId)
+{
+    return (enabledPlugins >> pluginId) & 1;
 }
 
 static int KeyboardSelectorDownCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
@@ -2697,6 +4169,38 @@ static int KeyboardSelectorUpCommand(XPLMCommandRef inCommand, XPLMCommandPhase
     return 0;
 }
 
+static void LoadCalibration(void)
+{
+    FILE *file = fopen(CALIBRATION_PATH, "rb");
+    if (file)
+    {
+        int readNumDeviceCalibrations = 0;
+        if (fread(&readNumDeviceCalibrations, sizeof(int), 1, file) == 1 && readNumDeviceCalibrations > 0 && readNumDeviceCalibrations <= MAX_CALIBRATED_DEVICES && fread(deviceCalibrations, sizeof(DeviceCalibration), readNumDeviceCalibrations, file) == (size_t) readNumDeviceCalibrations)
+        {
+            numDeviceCalibrations = readNumDeviceCalibrations;
+
+            // fall back to a nominal calibration for any axis whose stored values are not plausible
+            for (int i = 0; i < numDeviceCalibrations; i++)
+            {
+                for (int j = 0; j < 4; j++)
+                {
+                    AxisCalibration *axis = &deviceCalibrations[i].axes[j];
+                    if (!(isfinite(axis->center) && isfinite(axis->minimum) && isfinite(axis->maximum) && axis->minimum >= 0.0f && axis->minimum <= axis->center && axis->center <= axis->maximum && axis->maximum <= 1.0f && fabsf(axis->center - 0.5f) < CALIBRATION_MAX_CENTER_OFFSET))
+                    {
+                        axis->center = 0.5f;
+                        axis->minimum = 0.5f;
+                        axis->maximum = 0.5f;
+                    }
+                }
+            }
+        }
+        else
+            memset(deviceCalibrations, 0, sizeof deviceCalibrations);
+
+        fclose(file);
+    }
+}
+
 static int LockKeyboardKeyCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
 {
     if (!keyPressActive && inPhase == xplm_CommandBegin)
@@ -2705,6 +4209,8 @@ static int LockKeyboardKeyCommand(XPLMCommandRef inCommand, XPLMCommandPhase inP
             (*selectedKey).state = NEW_DOWN;
         else if ((*selectedKey).state == DOWN || (*selectedKey).state == NEW_DOWN)
             (*selectedKey).state = NEW_UP;
+
+        WakeFlightLoop();
     }
 
     return 0;
@@ -2712,12 +4218,9 @@ static int LockKeyboardKeyCommand(XPLMCommandRef inCommand, XPLMCommandPhase inP
 
 static int LookModifierCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
 {
-    int joystickAxisAssignments[100];
-    XPLMGetDatavi(joystickAxisAssignmentsDataRef, joystickAxisAssignments, 0, 100);
-
     if (inPhase == xplm_CommandEnd)
     {
-        if (mode == LOOK)
+        if (IsModeActive(LOOK))
         {
             // auto-center 3D cockpit view if it is only the defined distance or angle off from the center anyways
             if (XPLMGetDatai(viewTypeDataRef) == VIEW_TYPE_3D_COCKPIT_COMMAND_LOOK && fabs(defaultHeadPositionX - XPLMGetDataf(acfPeXDataRef)) <= AUTO_CENTER_VIEW_DISTANCE_LIMIT && fabs(defaultHeadPositionY - XPLMGetDataf(acfPeYDataRef)) <= AUTO_CENTER_VIEW_DISTANCE_LIMIT && fabs(defaultHeadPositionZ - XPLMGetDataf(acfPeZDataRef)) <= AUTO_CENTER_VIEW_DISTANCE_LIMIT)
@@ -2735,72 +4238,22 @@ static int LookModifierCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhas
                 }
             }
 
-            // assign the default controls to the left joystick's axis
-            joystickAxisAssignments[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)] = AXIS_ASSIGNMENT_YAW;
-            joystickAxisAssignments[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] = AXIS_ASSIGNMENT_NONE;
-
-            // assign the default controls to the DS4 triggers
-            if (settings.controllerType == DS4)
-            {
-                joystickAxisAssignments[JOYSTICK_AXIS_DS4_L2  + settings.axisOffset] = AXIS_ASSIGNMENT_LEFT_TOE_BRAKE;
-                joystickAxisAssignments[JOYSTICK_AXIS_DS4_R2  + settings.axisOffset] = AXIS_ASSIGNMENT_RIGHT_TOE_BRAKE;
-            }
-
-            // restore the default button assignments
-            PopButtonAssignments();
+            // restore the axis and button assignments that were overridden by the look mode
+            PopModeLayer(LOOK);
 
             // restore camera controls
             RestoreCameraControls();
-
-            mode = DEFAULT;
         }
     }
-    else if (mode == DEFAULT)
+    else if (CanPushModeLayer(LOOK))
     {
-        mode = LOOK;
-
-        // unassign the left joystick's axis
-        joystickAxisAssignments[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)] = AXIS_ASSIGNMENT_NONE;
-        joystickAxisAssignments[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] = AXIS_ASSIGNMENT_NONE;
-
-        // unassign the DS4 triggers
-        if (settings.controllerType == DS4)
-        {
-            joystickAxisAssignments[JOYSTICK_AXIS_DS4_L2  + settings.axisOffset] = AXIS_ASSIGNMENT_NONE;
-            joystickAxisAssignments[JOYSTICK_AXIS_DS4_R2  + settings.axisOffset] = AXIS_ASSIGNMENT_NONE;
-        }
-
-        // store the default button assignments
-        PushButtonAssignments();
-
-        // assign panel scrolling controls to the dpad
-        int joystickButtonAssignments[1600];
-        XPLMGetDatavi(joystickButtonAssignmentsDataRef, joystickButtonAssignments, 0, 1600);
-
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT)] = (intptr_t)XPLMFindCommand("sim/general/left");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT)] = (intptr_t)XPLMFindCommand("sim/general/right");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_UP)] = (intptr_t)XPLMFindCommand("sim/general/up");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN)] = (intptr_t)XPLMFindCommand("sim/general/down");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_LEFT)] = (intptr_t)XPLMFindCommand("sim/general/rot_left");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT)] = (intptr_t)XPLMFindCommand("sim/general/rot_right");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_UP)] = (intptr_t)XPLMFindCommand("sim/general/forward");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_DOWN)] = (intptr_t)XPLMFindCommand("sim/general/backward");
-
-        // assign push-to-talk and autopilot controls to the DS4 triggers
-        if (settings.controllerType == DS4)
-        {
-            joystickButtonAssignments[JOYSTICK_BUTTON_DS4_L2 + settings.buttonOffset] = (intptr_t)XPLMFindCommand(PUSH_TO_TALK_COMMAND);
-            joystickButtonAssignments[JOYSTICK_BUTTON_DS4_R2 + settings.buttonOffset] = (intptr_t)XPLMFindCommand(CWS_OR_DISCONNECT_AUTOPILOT);
-        }
-
-        XPLMSetDatavi(joystickButtonAssignmentsDataRef, joystickButtonAssignments, 0, 1600);
+        // unassign the left joystick's axis and the DS4 triggers and assign panel scrolling controls to the dpad
+        PushModeLayer(LOOK);
 
         // temporarily gain exclusive camera controls
         OverrideCameraControls();
     }
 
-    XPLMSetDatavi(joystickAxisAssignmentsDataRef, joystickAxisAssignments, 0, 100);
-
     return 0;
 }
 
@@ -2835,7 +4288,7 @@ static void MenuHandlerCallback(void *inMenuRef, void *inItemRef)
     if (settingsWidget == NULL)
     {
         // create settings widget
-        int x = 10, y = 0, w = 500, h = 375;
+        int x = 10, y = 0, w = 500, h = 450;
         XPLMGetScreenSize(NULL, &y);
         y -= 100;
 
@@ -2880,24 +4333,46 @@ static void MenuHandlerCallback(void *inMenuRef, void *inItemRef)
         startConfigurationtButton = XPCreateWidget(x + 30, y - 200, x + 200 + 30, y - 215, 1, "", 0, settingsWidget, xpWidgetClass_Button);
         XPSetWidgetProperty(startConfigurationtButton, xpProperty_ButtonType, xpPushButton);
 
-        // add indicators sub window
-        XPCreateWidget(x + 10, y - 240, x2 - 10, y - 285 - 10, 1, "", 0, settingsWidget, xpWidgetClass_SubWindow);
+        // add options sub window
+        XPCreateWidget(x + 10, y - 240, x2 - 10, y - 360 - 10, 1, "", 0, settingsWidget, xpWidgetClass_SubWindow);
 
-        // add indicators caption
-        XPCreateWidget(x + 10, y - 240, x2 - 20, y - 265, 1, "Indicators:", 0, settingsWidget, xpWidgetClass_Caption);
+        // add options caption
+        XPCreateWidget(x + 10, y - 240, x2 - 20, y - 265, 1, "Options:", 0, settingsWidget, xpWidgetClass_Caption);
 
         // add show indicators radio button
         showIndicatorsCheckbox = XPCreateWidget(x + 20, y - 270, x + 300 + 20, y - 285, 1, "Show Indicators", 0, settingsWidget, xpWidgetClass_Button);
         XPSetWidgetProperty(showIndicatorsCheckbox, xpProperty_ButtonType, xpRadioButton);
         XPSetWidgetProperty(showIndicatorsCheckbox, xpProperty_ButtonBehavior, xpButtonBehaviorCheckBox);
 
+        // add smooth stick input checkbox
+        smoothStickInputCheckbox = XPCreateWidget(x + 20, y - 295, x + 300 + 20, y - 310, 1, "Smooth Stick Input", 0, settingsWidget, xpWidgetClass_Button);
+        XPSetWidgetProperty(smoothStickInputCheckbox, xpProperty_ButtonType, xpRadioButton);
+        XPSetWidgetProperty(smoothStickInputCheckbox, xpProperty_ButtonBehavior, xpButtonBehaviorCheckBox);
+
+        // add axis settings button
+        axisSettingsButton = XPCreateWidget(x + 330, y - 295, x + 150 + 330, y - 310, 1, "Axis Settings", 0, settingsWidget, xpWidgetClass_Button);
+        XPSetWidgetProperty(axisSettingsButton, xpProperty_ButtonType, xpPushButton);
+
+        // add direct input checkbox, reading the controller directly is only supported on linux
+        directInputCheckbox = XPCreateWidget(x + 20, y - 320, x + 300 + 20, y - 335, 1, "Read Controller Directly (Linux only)", 0, settingsWidget, xpWidgetClass_Button);
+        XPSetWidgetProperty(directInputCheckbox, xpProperty_ButtonType, xpRadioButton);
+        XPSetWidgetProperty(directInputCheckbox, xpProperty_ButtonBehavior, xpButtonBehaviorCheckBox);
+#if !LIN
+        XPSetWidgetProperty(directInputCheckbox, xpProperty_Enabled, 0);
+#endif
+
+        // add direct button dispatch checkbox
+        directButtonDispatchCheckbox = XPCreateWidget(x + 20, y - 345, x + 300 + 20, y - 360, 1, "Dispatch Button Commands Directly", 0, settingsWidget, xpWidgetClass_Button);
+        XPSetWidgetProperty(directButtonDispatchCheckbox, xpProperty_ButtonType, xpRadioButton);
+        XPSetWidgetProperty(directButtonDispatchCheckbox, xpProperty_ButtonBehavior, xpButtonBehaviorCheckBox);
+
         // add about sub window
-        XPCreateWidget(x + 10, y - 310, x2 - 10, y - 355 - 10, 1, "", 0, settingsWidget, xpWidgetClass_SubWindow);
+        XPCreateWidget(x + 10, y - 385, x2 - 10, y - 430 - 10, 1, "", 0, settingsWidget, xpWidgetClass_SubWindow);
 
         // add about caption
-        XPCreateWidget(x + 10, y - 310, x2 - 20, y - 325, 1, NAME " " VERSION, 0, settingsWidget, xpWidgetClass_Caption);
-        XPCreateWidget(x + 10, y - 325, x2 - 20, y - 340, 1, "Thank you for using " NAME " by Matteo Hausner", 0, settingsWidget, xpWidgetClass_Caption);
-        XPCreateWidget(x + 10, y - 340, x2 - 20, y - 355, 1, "Contact: matteo.hausner@gmail.com or bwravencl.de", 0, settingsWidget, xpWidgetClass_Caption);
+        XPCreateWidget(x + 10, y - 385, x2 - 20, y - 400, 1, NAME " " VERSION, 0, settingsWidget, xpWidgetClass_Caption);
+        XPCreateWidget(x + 10, y - 400, x2 - 20, y - 415, 1, "Thank you for using " NAME " by Matteo Hausner", 0, settingsWidget, xpWidgetClass_Caption);
+        XPCreateWidget(x + 10, y - 415, x2 - 20, y - 430, 1, "Contact: matteo.hausner@gmail.com or bwravencl.de", 0, settingsWidget, xpWidgetClass_Caption);
 
         // init checkbox and slider positions
         UpdateSettingsWidgets();
@@ -3008,6 +4483,44 @@ static float Normalize(float value, float inMin, float inMax, float outMin, floa
     return newValue;
 }
 
+#if LIN
+static int OpenEvdevDevice(void)
+{
+    DIR *directory = opendir(EVDEV_DIRECTORY);
+    if (directory == NULL)
+        return -1;
+
+    // pick the first event device that has two sticks and gamepad buttons - this also matches virtual gamepads created through uinput
+    int fd = -1;
+    struct dirent *entry;
+    while (fd == -1 && (entry = readdir(directory)) != NULL)
+    {
+        if (strncmp(entry->d_name, "event", 5) != 0)
+            continue;
+
+        char path[sizeof(EVDEV_DIRECTORY) + 256];
+        snprintf(path, sizeof path, EVDEV_DIRECTORY "/%s", entry->d_name);
+
+        fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd == -1)
+            continue;
+
+        unsigned long absBits[ABS_MAX / (8 * sizeof(unsigned long)) + 1] = {0};
+        unsigned long keyBits[KEY_MAX / (8 * sizeof(unsigned long)) + 1] = {0};
+        const int bitsPerLong = 8 * sizeof(unsigned long);
+        if (ioctl(fd, EVIOCGBIT(EV_ABS, sizeof absBits), absBits) == -1 || ioctl(fd, EVIOCGBIT(EV_KEY, sizeof keyBits), keyBits) == -1 || !(absBits[ABS_X / bitsPerLong] & (1ul << (ABS_X % bitsPerLong))) || !(absBits[ABS_RX / bitsPerLong] & (1ul << (ABS_RX % bitsPerLong))) || !(keyBits[BTN_GAMEPAD / bitsPerLong] & (1ul << (BTN_GAMEPAD % bitsPerLong))))
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    closedir(directory);
+
+    return fd;
+}
+#endif
+
 static void OverrideCameraControls(void)
 {
     // disable cinema verite if it is enabled and store its status
@@ -3016,18 +4529,99 @@ static void OverrideCameraControls(void)
         XPLMSetDatai(cinemaVeriteDataRef, 0);
 
     // temporarily disable HeadShake
-    if (IsPluginEnabled(HEAD_SHAKE_PLUGIN_SIGNATURE))
-        XPLMCommandOnce(XPLMFindCommand("simcoders/headshake/stop"));
+    if (IsPluginEnabled(PLUGIN_HEAD_SHAKE))
+        XPLMCommandOnce(GetCommand(COMMAND_HEAD_SHAKE_STOP));
+}
+
+static void PackButtonValues(const int *buttonValues, int numButtons, uint64_t *buttonBits)
+{
+    memset(buttonBits, 0, (numButtons + 63) / 64 * sizeof(uint64_t));
+
+    int i = 0;
+#if USE_SSE2
+    // compare four button values against zero at once, since four is a divisor of 64 the resulting bits never straddle two words
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= numButtons; i += 4)
+    {
+        const int releasedMask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(buttonValues + i)), zero)));
+        buttonBits[i / 64] |= (uint64_t)(~releasedMask & 0xF) << (i % 64);
+    }
+#endif
+    for (; i < numButtons; i++)
+    {
+        if (buttonValues[i])
+            buttonBits[i / 64] |= (uint64_t)1 << (i % 64);
+    }
+}
+
+static int ParseCurvePoints(const char *text, CurveConfig *curveConfig)
+{
+    // the points are given as x,y pairs within [0.0, 1.0] that are separated by spaces, their x values must be ascending
+    float points[MAX_RESPONSE_CURVE_POINTS][2];
+    int numPoints = 0, consumed = 0;
+    float x, y;
+    while (sscanf(text, " %f , %f%n", &x, &y, &consumed) == 2)
+    {
+        if (numPoints == MAX_RESPONSE_CURVE_POINTS || x < 0.0f || x > 1.0f || y < 0.0f || y > 1.0f || (numPoints > 0 && x <= points[numPoints - 1][0]))
+            return 0;
+
+        points[numPoints][0] = x;
+        points[numPoints][1] = y;
+        numPoints++;
+        text += consumed;
+    }
+
+    while (*text == ' ')
+        text++;
+
+    if (*text != '\0' || numPoints < 2)
+        return 0;
+
+    memcpy(curveConfig->points, points, numPoints * sizeof points[0]);
+    curveConfig->numPoints = numPoints;
+
+    return 1;
 }
 
-static void PopButtonAssignments(void)
+static int PopModeLayer(Mode m)
 {
-    if (pushedJoystickButtonAssignments)
+    const int layerIndex = FindModeLayer(m);
+    if (layerIndex < 0)
+        return 0;
+
+    for (int t = 0; t < NUM_OVERLAY_TYPES; t++)
     {
-        XPLMSetDatavi(joystickButtonAssignmentsDataRef, pushedJoystickButtonAssignments, 0, 1600);
-        free(pushedJoystickButtonAssignments);
-        pushedJoystickButtonAssignments = NULL;
+        const AssignmentOverlay *previousOverlay = &modeLayers[layerIndex].previousOverlays[t];
+        AssignmentOverlay restoreOverlay = {0};
+
+        for (int i = 0; i < previousOverlay->numEntries; i++)
+        {
+            const AssignmentOverlayEntry *entry = &previousOverlay->entries[i];
+
+            // if a higher layer also overrides this slot its assignment stays in effect, but that layer now has to restore what the popped layer replaced
+            AssignmentOverlayEntry *higherEntry = NULL;
+            for (int j = layerIndex + 1; j < numModeLayers && higherEntry == NULL; j++)
+                higherEntry = FindOverlayEntry(&modeLayers[j].previousOverlays[t], entry->index);
+
+            if (higherEntry)
+                higherEntry->assignment = entry->assignment;
+            else
+                restoreOverlay.entries[restoreOverlay.numEntries++] = *entry;
+        }
+
+        if (t == AXIS_OVERLAY)
+            ApplyAxisOverlay(&restoreOverlay, NULL);
+        else
+            ApplyButtonOverlay(&restoreOverlay, NULL);
     }
+
+    numModeLayers--;
+    for (int i = layerIndex; i < numModeLayers; i++)
+        modeLayers[i] = modeLayers[i + 1];
+
+    mode = numModeLayers > 0 ? modeLayers[numModeLayers - 1].mode : DEFAULT;
+
+    return 1;
 }
 
 static int PressKeyboardKeyCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
@@ -3043,6 +4637,7 @@ static int PressKeyboardKeyCommand(XPLMCommandRef inCommand, XPLMCommandPhase in
             (*selectedKey).state = NEW_UP;
 
         keyPressActive = 1;
+        WakeFlightLoop();
     }
     else if (inPhase == xplm_CommandEnd && ((*selectedKey).state == DOWN || (*selectedKey).state == NEW_DOWN))
     {
@@ -3060,29 +4655,71 @@ static int PropPitchOrThrottleModifierCommand(XPLMCommandRef inCommand, XPLMComm
     return 0;
 }
 
-static void PushButtonAssignments(void)
+#if LIN
+static void PublishControllerState(const ControllerState *state)
 {
-    if (pushedJoystickButtonAssignments == NULL)
-    {
-        pushedJoystickButtonAssignments = (int *)malloc(sizeof(int) * 1600);
-        XPLMGetDatavi(joystickButtonAssignmentsDataRef, pushedJoystickButtonAssignments, 0, 1600);
-    }
+    // publish the state by swapping our buffer with the shared one and marking it as new
+    controllerStates[controllerStateBackIndex] = *state;
+    controllerStateBackIndex = atomic_exchange_explicit(&controllerStateExchange, controllerStateBackIndex | 4u, memory_order_acq_rel) & 3u;
+}
+#endif
+
+static void PushModeLayer(Mode m)
+{
+    if (numModeLayers == MAX_MODE_LAYERS)
+        return;
+
+    ModeLayer *modeLayer = &modeLayers[numModeLayers++];
+    modeLayer->mode = m;
+
+    // only the slots of the precompiled overlays are written, their current assignments are kept so that the layer can be popped again in any order
+    ApplyAxisOverlay(&modeOverlayTable.axisOverlays[m], &modeLayer->previousOverlays[AXIS_OVERLAY]);
+
+    // with direct dispatch the buttons stay claimed, the overlay is looked up when a button gets pressed
+    if (dispatchWindowCount > 0)
+        modeLayer->previousOverlays[BUTTON_OVERLAY].numEntries = 0;
+    else
+        ApplyButtonOverlay(&modeOverlayTable.buttonOverlays[m], &modeLayer->previousOverlays[BUTTON_OVERLAY]);
+
+    mode = m;
+    WakeFlightLoop();
 }
 
 static int PushToTalkCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
 {
+    TrackCommandPhase(inCommand, inPhase);
+
     // only do push-to-talk if X-IvAp or XSquawkBox is enabled
-    if (inPhase != xplm_CommandContinue && (IsPluginEnabled(X_IVAP_PLUGIN_SIGNATURE) || IsPluginEnabled(X_XSQUAWKBOX_PLUGIN_SIGNATURE)))
+    if (inPhase != xplm_CommandContinue && (IsPluginEnabled(PLUGIN_X_IVAP) || IsPluginEnabled(PLUGIN_X_XSQUAWKBOX)))
     {
         if (inPhase == xplm_CommandBegin)
             oKeyboardKey.state = NEW_DOWN;
         else if (inPhase == xplm_CommandEnd)
             oKeyboardKey.state = NEW_UP;
+
+        WakeFlightLoop();
     }
 
     return 0;
 }
 
+static void RecompileAxisBindings(Mode m, int abstractAxisIndex)
+{
+    CompileAxisBindings();
+
+    // bound axes are unassigned on X-Plane's side while their mode is active
+    modeOverlaysStale = 1;
+    UpdateModeOverlays();
+
+    // outside of any mode the axis gets its new assignment right away
+    const int axisIndex = AxisIndex(abstractAxisIndex);
+    if (m == DEFAULT && axisIndex >= 0 && XPLMGetDatai(hasJoystickDataRef) && mode == DEFAULT)
+    {
+        int assignment = GetDefaultAxisAssignment(abstractAxisIndex);
+        XPLMSetDatavi(joystickAxisAssignmentsDataRef, &assignment, axisIndex, 1);
+    }
+}
+
 static void ReleaseAllKeys(void)
 {
     KeyboardKey **ptr = keyboardKeys;
@@ -3098,77 +4735,105 @@ static void ReleaseAllKeys(void)
     }
 }
 
-inline static void SyncLockKeyState(KeyboardKey *keyboardKey)
+static void ReleaseDispatchedButtons(void)
 {
-#if IBM
-    const int vk = MapVirtualKeyA((*keyboardKey).keyCode, MAPVK_VSC_TO_VK);
-    const int toggled = (GetKeyState(vk) & 1) != 0;
-    (*keyboardKey).state = toggled ? DOWN : UP;
-#elif APL
-    if ((*keyboardKey).keyCode != KEY_CODE_CAPITAL)
-        return;
-    const int toggled = (GetCurrentKeyModifiers() & alphaLock) != 0;
-    (*keyboardKey).state = toggled ? DOWN : UP;
-#elif LIN
-// TODO
-#endif
+    for (int i = 0; i < MAX_DISPATCH_BUTTONS; i++)
+    {
+        EndCommand(dispatchedCommands[i]);
+        dispatchedCommands[i] = NULL;
+    }
+
+    dispatchButtonStates = 0;
 }
 
 static int ResetSwitchViewCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
 {
     if (inPhase == xplm_CommandEnd)
     {
-        if (mode == SWITCH_VIEW)
-        {
-            // restore the default button assignments
-            PopButtonAssignments();
-
-            mode = DEFAULT;
-        }
+        // restore the button assignments that were overridden by the switch view mode
+        PopModeLayer(SWITCH_VIEW);
     }
-    else if (mode == DEFAULT)
+    else if (CanPushModeLayer(SWITCH_VIEW))
     {
         // reset view
         switch (XPLMGetDatai(viewTypeDataRef))
         {
         case VIEW_TYPE_FORWARDS_WITH_PANEL:
-            XPLMCommandOnce(XPLMFindCommand("sim/view/3d_cockpit_cmnd_look"));
-            XPLMCommandOnce(XPLMFindCommand("sim/view/forward_with_2d_panel"));
+            XPLMCommandOnce(GetCommand(COMMAND_VIEW_3D_COCKPIT_COMMAND_LOOK));
+            XPLMCommandOnce(GetCommand(COMMAND_VIEW_FORWARD_WITH_2D_PANEL));
             break;
 
         case VIEW_TYPE_3D_COCKPIT_COMMAND_LOOK:
-            XPLMCommandOnce(XPLMFindCommand("sim/view/forward_with_2d_panel"));
-            XPLMCommandOnce(XPLMFindCommand("sim/view/3d_cockpit_cmnd_look"));
+            XPLMCommandOnce(GetCommand(COMMAND_VIEW_FORWARD_WITH_2D_PANEL));
+            XPLMCommandOnce(GetCommand(COMMAND_VIEW_3D_COCKPIT_COMMAND_LOOK));
             break;
 
         case VIEW_TYPE_CHASE:
-            XPLMCommandOnce(XPLMFindCommand("sim/view/circle"));
-            XPLMCommandOnce(XPLMFindCommand("sim/view/chase"));
+            XPLMCommandOnce(GetCommand(COMMAND_VIEW_CIRCLE));
+            XPLMCommandOnce(GetCommand(COMMAND_VIEW_CHASE));
             break;
         }
 
-        if (mode == DEFAULT)
-        {
-            mode = SWITCH_VIEW;
+        // assign view controls to face buttons
+        PushModeLayer(SWITCH_VIEW);
+    }
 
-            // store the default button assignments
-            PushButtonAssignments();
+    return 0;
+}
+
+static XPLMCommandRef ResolveButtonCommand(int index)
+{
+    // the topmost mode layer that assigns the button wins, otherwise the default assignment applies
+    for (int i = numModeLayers - 1; i >= 0; i--)
+    {
+        const AssignmentOverlayEntry *entry = FindOverlayEntry(&modeOverlayTable.buttonOverlays[modeLayers[i].mode], index);
+        if (entry)
+            return (XPLMCommandRef)(intptr_t)entry->assignment;
+    }
 
-            // assign view controls to face buttons
-            int joystickButtonAssignments[1600];
-            XPLMGetDatavi(joystickButtonAssignmentsDataRef, joystickButtonAssignments, 0, 1600);
+    const AssignmentOverlayEntry *entry = FindOverlayEntry(&modeOverlayTable.buttonOverlays[DEFAULT], index);
+    if (entry)
+        return (XPLMCommandRef)(intptr_t)entry->assignment;
 
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT)] = (intptr_t)XPLMFindCommand("sim/view/chase");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT)] = (intptr_t)XPLMFindCommand("sim/view/forward_with_hud");
-            int has2DPanel = Has2DPanel();
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_UP)] = (intptr_t)XPLMFindCommand(has2DPanel ? "sim/view/forward_with_2d_panel" : "sim/view/3d_cockpit_cmnd_look");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN)] = (intptr_t)XPLMFindCommand(has2DPanel ? "sim/view/3d_cockpit_cmnd_look" : "sim/view/forward_with_2d_panel");
+    // buttons that none of our modes use keep doing whatever they were assigned to before we claimed them
+    return index >= dispatchWindowStart && index < dispatchWindowStart + dispatchWindowCount ? (XPLMCommandRef)(intptr_t)dispatchSavedAssignments[index - dispatchWindowStart] : NULL;
+}
 
-            XPLMSetDatavi(joystickButtonAssignmentsDataRef, joystickButtonAssignments, 0, 1600);
-        }
+inline static void SyncLockKeyState(KeyboardKey *keyboardKey)
+{
+#if IBM
+    const int vk = MapVirtualKeyA((*keyboardKey).keyCode, MAPVK_VSC_TO_VK);
+    const int toggled = (GetKeyState(vk) & 1) != 0;
+    (*keyboardKey).state = toggled ? DOWN : UP;
+#elif APL
+    if ((*keyboardKey).keyCode != KEY_CODE_CAPITAL)
+        return;
+    const int toggled = (GetCurrentKeyModifiers() & alphaLock) != 0;
+    (*keyboardKey).state = toggled ? DOWN : UP;
+#elif LIN
+// TODO
+#endif
+}
+
+static void ResolveCommands(void)
+{
+    for (int i = 0; i < NUM_COMMANDS; i++)
+        commandRefs[i] = XPLMFindCommand(commandNames[i]);
+
+    // the modifier overlays might reference commands that did not exist before
+    modeOverlaysStale = 1;
+}
+
+static void ResolveThirdPartyDataRefs(void)
+{
+    // a dataref handle stays around after its owner has been unloaded, so we only keep the handles that are currently backed by a plugin
+    for (int i = 0; i < NUM_THIRD_PARTY_DATAREFS; i++)
+    {
+        const XPLMDataRef dataRef = XPLMFindDataRef(thirdPartyDataRefNames[i]);
+        thirdPartyDataRefs[i] = dataRef && XPLMIsDataRefGood(dataRef) ? dataRef : NULL;
     }
 
-    return 0;
+    thirdPartyDataRefsStale = 0;
 }
 
 static void RestoreCameraControls(void)
@@ -3178,6 +4843,21 @@ static void RestoreCameraControls(void)
         XPLMSetDatai(cinemaVeriteDataRef, 1);
 }
 
+static void SaveCalibration(void)
+{
+    if (!calibrationChanged || numDeviceCalibrations == 0)
+        return;
+
+    FILE *file = fopen(CALIBRATION_PATH, "wb");
+    if (file)
+    {
+        fwrite(&numDeviceCalibrations, sizeof(int), 1, file);
+        fwrite(deviceCalibrations, sizeof(DeviceCalibration), numDeviceCalibrations, file);
+        fclose(file);
+        calibrationChanged = 0;
+    }
+}
+
 static void SaveSettings(void)
 {
     FILE *file = fopen(CONFIG_PATH, "w");
@@ -3232,6 +4912,30 @@ static int ScrollUpCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, v
     return 0;
 }
 
+static void SetDatafCached(XPLMDataRef dataRef, float value)
+{
+    if (UpdateWriteCache(dataRef, 0, 0, value))
+        XPLMSetDataf(dataRef, value);
+}
+
+static void SetDatavfCached(XPLMDataRef dataRef, float *values, int offset, int count)
+{
+    // only write the range of elements that actually changed
+    int first = -1, last = -1;
+    for (int i = 0; i < count; i++)
+    {
+        if (UpdateWriteCache(dataRef, offset + i, 1, values[i]))
+        {
+            if (first < 0)
+                first = i;
+            last = i;
+        }
+    }
+
+    if (first >= 0)
+        XPLMSetDatavf(dataRef, values + first, offset + first, last - first + 1);
+}
+
 static void SetDefaultAssignments(void)
 {
     // only set default assignments if a joystick is found and if no modifier is down which can alter any assignments
@@ -3241,64 +4945,35 @@ static void SetDefaultAssignments(void)
         int joystickAxisAssignments[100];
         XPLMGetDatavi(joystickAxisAssignmentsDataRef, joystickAxisAssignments, 0, 100);
 
-        joystickAxisAssignments[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)] = AXIS_ASSIGNMENT_YAW;
-        joystickAxisAssignments[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] = AXIS_ASSIGNMENT_NONE;
-        joystickAxisAssignments[AxisIndex(JOYSTICK_AXIS_ABSTRACT_RIGHT_X)] = AXIS_ASSIGNMENT_ROLL;
-        joystickAxisAssignments[AxisIndex(JOYSTICK_AXIS_ABSTRACT_RIGHT_Y)] = AXIS_ASSIGNMENT_PITCH;
-        if (settings.controllerType == XBOX360)
+        for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
         {
+            const int axisIndex = AxisIndex(i);
+            if (axisIndex >= 0)
+                joystickAxisAssignments[axisIndex] = GetDefaultAxisAssignment(i);
+        }
 #if IBM
+        // with XInput the triggers of an Xbox 360 controller are read directly, the shared axis must not control anything
+        if (settings.controllerType == XBOX360)
             joystickAxisAssignments[JOYSTICK_AXIS_XBOX360_TRIGGERS + settings.axisOffset] = AXIS_ASSIGNMENT_NONE;
-#else
-            joystickAxisAssignments[JOYSTICK_AXIS_XBOX360_LEFT_TRIGGER + settings.axisOffset] = AXIS_ASSIGNMENT_NONE;
-            joystickAxisAssignments[JOYSTICK_AXIS_XBOX360_RIGHT_TRIGGER + settings.axisOffset] = AXIS_ASSIGNMENT_NONE;
 #endif
-        }
-        else if (settings.controllerType == DS4)
-        {
-            joystickAxisAssignments[JOYSTICK_AXIS_DS4_L2 + settings.axisOffset] = AXIS_ASSIGNMENT_LEFT_TOE_BRAKE;
-            joystickAxisAssignments[JOYSTICK_AXIS_DS4_R2 + settings.axisOffset] = AXIS_ASSIGNMENT_RIGHT_TOE_BRAKE;
-        }
 
         XPLMSetDatavi(joystickAxisAssignmentsDataRef, joystickAxisAssignments, 0, 100);
 
-        // set default button assignments
-        int joystickButtonAssignments[1600];
-        XPLMGetDatavi(joystickButtonAssignmentsDataRef, joystickButtonAssignments, 0, 1600);
-
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT)] = (intptr_t)XPLMFindCommand("sim/flight_controls/flaps_up");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT)] = (intptr_t)XPLMFindCommand("sim/flight_controls/flaps_down");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_UP)] = (intptr_t)XPLMFindCommand(TOGGLE_ARM_SPEED_BRAKE_OR_TOGGLE_CARB_HEAT_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN)] = (intptr_t)XPLMFindCommand("sim/flight_controls/landing_gear_toggle");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT_UP)] = (intptr_t)XPLMFindCommand("sim/none/none");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT_DOWN)] = (intptr_t)XPLMFindCommand("sim/none/none");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT_UP)] = (intptr_t)XPLMFindCommand("sim/none/none");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT_DOWN)] = (intptr_t)XPLMFindCommand("sim/none/none");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_LEFT)] = (intptr_t)XPLMFindCommand(CYCLE_RESET_VIEW_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT)] = (intptr_t)XPLMFindCommand(MIXTURE_CONTROL_MODIFIER_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_UP)] = (intptr_t)XPLMFindCommand(PROP_PITCH_THROTTLE_MODIFIER_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_DOWN)] = (intptr_t)XPLMFindCommand(COWL_FLAP_MODIFIER_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_CENTER_LEFT)] = (intptr_t)XPLMFindCommand(TOGGLE_REVERSE_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_CENTER_RIGHT)] = (intptr_t)XPLMFindCommand("sim/flight_controls/brakes_toggle_max");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_BUMPER_LEFT)] = (intptr_t)XPLMFindCommand(TRIM_MODIFIER_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_BUMPER_RIGHT)] = (intptr_t)XPLMFindCommand(LOOK_MODIFIER_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_STICK_LEFT)] = (intptr_t)XPLMFindCommand("sim/general/zoom_out");
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_STICK_RIGHT)] = (intptr_t)XPLMFindCommand("sim/general/zoom_in");
-        switch (settings.controllerType)
-        {
-        case XBOX360:
-#if !IBM
-            joystickButtonAssignments[JOYSTICK_BUTTON_XBOX360_GUIDE + settings.buttonOffset] = (intptr_t)XPLMFindCommand(TOGGLE_MOUSE_OR_KEYBOARD_CONTROL_COMMAND);
-#endif
-            break;
-        case DS4:
-            joystickButtonAssignments[JOYSTICK_BUTTON_DS4_L2 + settings.buttonOffset] = (intptr_t)XPLMFindCommand("sim/none/none");
-            joystickButtonAssignments[JOYSTICK_BUTTON_DS4_R2 + settings.buttonOffset] = (intptr_t)XPLMFindCommand("sim/none/none");
-            joystickButtonAssignments[JOYSTICK_BUTTON_DS4_PS + settings.buttonOffset] = (intptr_t)XPLMFindCommand(TOGGLE_MOUSE_OR_KEYBOARD_CONTROL_COMMAND);
-            break;
+        // set default button assignments, with direct dispatch the buttons stay claimed and the default assignments take effect once they are handed back to X-Plane
+        UpdateModeOverlays();
+        UpdateButtonDispatch();
+        if (dispatchWindowCount > 0)
+        {
+            const AssignmentOverlay *defaultOverlay = &modeOverlayTable.buttonOverlays[DEFAULT];
+            for (int i = 0; i < defaultOverlay->numEntries; i++)
+            {
+                const int index = defaultOverlay->entries[i].index - dispatchWindowStart;
+                if (index >= 0 && index < dispatchWindowCount)
+                    dispatchSavedAssignments[index] = defaultOverlay->entries[i].assignment;
+            }
         }
-
-        XPLMSetDatavi(joystickButtonAssignmentsDataRef, joystickButtonAssignments, 0, 1600);
+        else
+            ApplyButtonOverlay(&modeOverlayTable.buttonOverlays[DEFAULT], NULL);
 
         // set default nullzone
         XPLMSetDataf(joystickPitchNullzoneDataRef, DEFAULT_NULLZONE);
@@ -3315,7 +4990,7 @@ static void SetDefaultAssignments(void)
 static void SetToLissThrottle(float throttleRatio)
 {
     // the ToLiss A319 uses a custom dataref for throttle control, modifying the default throttle-ratio datarefs has no effect
-    const XPLMDataRef airbusThrottleInputDataRef = XPLMFindDataRef("AirbusFBW/throttle_input");
+    const XPLMDataRef airbusThrottleInputDataRef = thirdPartyDataRefs[THIRD_PARTY_DATAREF_AIRBUS_THROTTLE_INPUT];
     if (airbusThrottleInputDataRef)
     {
         float throttleInput[] = {throttleRatio, throttleRatio};
@@ -3367,58 +5042,231 @@ static int SettingsWidgetHandler(XPWidgetMessage inMessage, XPWidgetID inWidget,
             settings.showIndicators = (int)XPGetWidgetProperty(showIndicatorsCheckbox, xpProperty_ButtonState, 0);
             UpdateIndicatorsWindow(-1);
 
+            return 1;
+        }
+        else if (inParam1 == (intptr_t)smoothStickInputCheckbox)
+        {
+            const int enabled = (int)XPGetWidgetProperty(smoothStickInputCheckbox, xpProperty_ButtonState, 0);
+            for (int i = 0; i < 4; i++)
+                settings.axisFilters[i].enabled = enabled;
+
+            return 1;
+        }
+        else if (inParam1 == (intptr_t)directInputCheckbox)
+        {
+            settings.directInput = (int)XPGetWidgetProperty(directInputCheckbox, xpProperty_ButtonState, 0);
+
+            return 1;
+        }
+        else if (inParam1 == (intptr_t)directButtonDispatchCheckbox)
+        {
+            settings.directButtonDispatch = (int)XPGetWidgetProperty(directButtonDispatchCheckbox, xpProperty_ButtonState, 0);
+            UpdateButtonDispatch();
+
             return 1;
         }
     }
-    else if (inMessage == xpMsg_PushButtonPressed && inParam1 == (intptr_t)startConfigurationtButton)
+    else if (inMessage == xpMsg_PushButtonPressed)
     {
-        if (configurationStep == AXES || configurationStep == BUTTONS)
-            configurationStep = ABORT;
-        else
-            configurationStep = AXES;
-        UpdateSettingsWidgets();
+        if (inParam1 == (intptr_t)startConfigurationtButton)
+        {
+            if (configurationStep == AXES || configurationStep == BUTTONS)
+                configurationStep = ABORT;
+            else
+            {
+                configurationStep = AXES;
+                WakeFlightLoop();
+            }
+            UpdateSettingsWidgets();
 
-        return 1;
+            return 1;
+        }
+        else if (inParam1 == (intptr_t)axisSettingsButton)
+        {
+            ShowAxisSettingsWidget();
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void ShowAxisSettingsWidget(void)
+{
+    if (axisSettingsWidget == NULL)
+    {
+        // create axis settings widget next to the settings widget
+        int x = 520, y = 0, w = 760, h = 620;
+        XPLMGetScreenSize(NULL, &y);
+        y -= 100;
+
+        int x2 = x + w;
+        int y2 = y - h;
+
+        // widget window
+        axisSettingsWidget = XPCreateWidget(x, y, x2, y2, 1, NAME " Axis Settings", 1, 0, xpWidgetClass_MainWindow);
+
+        // add close box
+        XPSetWidgetProperty(axisSettingsWidget, xpProperty_MainWindowHasCloseBoxes, 1);
+
+        // add response curves sub window
+        XPCreateWidget(x + 10, y - 30, x2 - 10, y - 175 - 10, 1, "", 0, axisSettingsWidget, xpWidgetClass_SubWindow);
+
+        // add response curves caption
+        XPCreateWidget(x + 10, y - 30, x2 - 20, y - 45, 1, "Response Curves (custom points are x,y pairs from 0 to 1):", 0, axisSettingsWidget, xpWidgetClass_Caption);
+
+        // add a curve type button and a custom points text field for each axis
+        for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
+        {
+            const int top = y - 60 - i * 20;
+
+            XPCreateWidget(x + 20, top, x + 120, top - 15, 1, axisNames[i], 0, axisSettingsWidget, xpWidgetClass_Caption);
+
+            curveTypeButtons[i] = XPCreateWidget(x + 130, top, x + 100 + 130, top - 15, 1, "", 0, axisSettingsWidget, xpWidgetClass_Button);
+            XPSetWidgetProperty(curveTypeButtons[i], xpProperty_ButtonType, xpPushButton);
+
+            char text[MAX_CURVE_POINTS_TEXT_LENGTH];
+            FormatCurvePoints(&settings.axisCurves[i], text, sizeof text);
+            curvePointsTextFields[i] = XPCreateWidget(x + 240, top, x2 - 20, top - 15, 1, text, 0, axisSettingsWidget, xpWidgetClass_TextField);
+            XPSetWidgetProperty(curvePointsTextFields[i], xpProperty_MaxCharacters, MAX_CURVE_POINTS_TEXT_LENGTH - 1);
+        }
+
+        // add deadzones sub window
+        XPCreateWidget(x + 10, y - 200, x2 - 10, y - 265 - 10, 1, "", 0, axisSettingsWidget, xpWidgetClass_SubWindow);
+
+        // add deadzones caption
+        XPCreateWidget(x + 10, y - 200, x2 - 20, y - 215, 1, "Deadzones:", 0, axisSettingsWidget, xpWidgetClass_Caption);
+
+        // add a deadzone type button and sliders for the inner, outer and anti-deadzone of each stick
+        static const char *stickNames[2] = {"Left Stick", "Right Stick"};
+        static const char *deadzoneSliderNames[3] = {"Inner", "Outer", "Anti"};
+        static const int deadzoneSliderMinimums[3] = {-1, 50, -1};
+        static const int deadzoneSliderMaximums[3] = {50, 100, 50};
+        for (int i = 0; i < 2; i++)
+        {
+            const int top = y - 230 - i * 20;
+
+            XPCreateWidget(x + 20, top, x + 120, top - 15, 1, stickNames[i], 0, axisSettingsWidget, xpWidgetClass_Caption);
+
+            deadzoneTypeButtons[i] = XPCreateWidget(x + 130, top, x + 80 + 130, top - 15, 1, "", 0, axisSettingsWidget, xpWidgetClass_Button);
+            XPSetWidgetProperty(deadzoneTypeButtons[i], xpProperty_ButtonType, xpPushButton);
+
+            for (int j = 0; j < 3; j++)
+            {
+                const int left = x + 220 + j * 160;
+                XPCreateWidget(left, top, left + 35, top - 15, 1, deadzoneSliderNames[j], 0, axisSettingsWidget, xpWidgetClass_Caption);
+                deadzoneSliders[i][j] = CreateSlider(left + 40, top, left + 110, top - 15, deadzoneSliderMinimums[j], deadzoneSliderMaximums[j]);
+                deadzoneValueCaptions[i][j] = XPCreateWidget(left + 115, top, left + 155, top - 15, 1, "", 0, axisSettingsWidget, xpWidgetClass_Caption);
+            }
+        }
+
+        // add smoothing sub window
+        XPCreateWidget(x + 10, y - 290, x2 - 10, y - 395 - 10, 1, "", 0, axisSettingsWidget, xpWidgetClass_SubWindow);
+
+        // add smoothing caption
+        XPCreateWidget(x + 10, y - 290, x2 - 20, y - 305, 1, "Smoothing (applies while 'Smooth Stick Input' is enabled):", 0, axisSettingsWidget, xpWidgetClass_Caption);
+
+        // add sliders for the minimum cutoff frequency and the speed coefficient of the filter of each stick axis
+        static const char *filterSliderNames[2] = {"Min Cutoff", "Beta"};
+        for (int i = 0; i < 4; i++)
+        {
+            const int top = y - 320 - i * 20;
+
+            XPCreateWidget(x + 20, top, x + 120, top - 15, 1, axisNames[i], 0, axisSettingsWidget, xpWidgetClass_Caption);
+
+            for (int j = 0; j < 2; j++)
+            {
+                const int left = x + 130 + j * 240;
+                XPCreateWidget(left, top, left + 65, top - 15, 1, filterSliderNames[j], 0, axisSettingsWidget, xpWidgetClass_Caption);
+                filterSliders[i][j] = CreateSlider(left + 70, top, left + 170, top - 15, j == 0 ? 1 : 0, 100);
+                filterValueCaptions[i][j] = XPCreateWidget(left + 175, top, left + 230, top - 15, 1, "", 0, axisSettingsWidget, xpWidgetClass_Caption);
+            }
+        }
+
+        // add bindings sub window
+        XPCreateWidget(x + 10, y - 420, x2 - 10, y - 595 - 10, 1, "", 0, axisSettingsWidget, xpWidgetClass_SubWindow);
+
+        // add bindings caption
+        XPCreateWidget(x + 10, y - 420, x2 - 20, y - 435, 1, "Bindings (axes that drive an actuator while a mode is active):", 0, axisSettingsWidget, xpWidgetClass_Caption);
+
+        // add mode button
+        XPCreateWidget(x + 20, y - 440, x + 120, y - 455, 1, "Mode", 0, axisSettingsWidget, xpWidgetClass_Caption);
+        bindingsModeButton = XPCreateWidget(x + 130, y - 440, x + 100 + 130, y - 455, 1, "", 0, axisSettingsWidget, xpWidgetClass_Button);
+        XPSetWidgetProperty(bindingsModeButton, xpProperty_ButtonType, xpPushButton);
+
+        // add column captions
+        static const char *bindingColumnNames[6] = {"Actuator", "Curve", "Invert", "Bounds", "Minimum", "Maximum"};
+        static const int bindingColumnLefts[6] = {130, 240, 350, 410, 480, 610};
+        for (int i = 0; i < 6; i++)
+            XPCreateWidget(x + bindingColumnLefts[i], y - 460, x + bindingColumnLefts[i] + 100, y - 475, 1, bindingColumnNames[i], 0, axisSettingsWidget, xpWidgetClass_Caption);
+
+        // add an actuator button, a curve button, an invert and a custom bounds checkbox and sliders for the custom bounds of each axis
+        for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
+        {
+            const int top = y - 480 - i * 20;
+
+            XPCreateWidget(x + 20, top, x + 120, top - 15, 1, axisNames[i], 0, axisSettingsWidget, xpWidgetClass_Caption);
+
+            actuatorButtons[i] = XPCreateWidget(x + 130, top, x + 100 + 130, top - 15, 1, "", 0, axisSettingsWidget, xpWidgetClass_Button);
+            XPSetWidgetProperty(actuatorButtons[i], xpProperty_ButtonType, xpPushButton);
+
+            bindingCurveButtons[i] = XPCreateWidget(x + 240, top, x + 100 + 240, top - 15, 1, "", 0, axisSettingsWidget, xpWidgetClass_Button);
+            XPSetWidgetProperty(bindingCurveButtons[i], xpProperty_ButtonType, xpPushButton);
+
+            invertCheckboxes[i] = XPCreateWidget(x + 350, top, x + 20 + 350, top - 15, 1, "", 0, axisSettingsWidget, xpWidgetClass_Button);
+            XPSetWidgetProperty(invertCheckboxes[i], xpProperty_ButtonType, xpRadioButton);
+            XPSetWidgetProperty(invertCheckboxes[i], xpProperty_ButtonBehavior, xpButtonBehaviorCheckBox);
+
+            customBoundsCheckboxes[i] = XPCreateWidget(x + 410, top, x + 60 + 410, top - 15, 1, "Custom", 0, axisSettingsWidget, xpWidgetClass_Button);
+            XPSetWidgetProperty(customBoundsCheckboxes[i], xpProperty_ButtonType, xpRadioButton);
+            XPSetWidgetProperty(customBoundsCheckboxes[i], xpProperty_ButtonBehavior, xpButtonBehaviorCheckBox);
+
+            for (int j = 0; j < 2; j++)
+            {
+                const int left = x + 480 + j * 130;
+                boundsSliders[i][j] = CreateSlider(left, top, left + 80, top - 15, 0, 100);
+                boundsValueCaptions[i][j] = XPCreateWidget(left + 85, top, left + 125, top - 15, 1, "", 0, axisSettingsWidget, xpWidgetClass_Caption);
+            }
+        }
+
+        // init button and text field states
+        UpdateAxisSettingsWidgets();
+
+        // register widget handler
+        XPAddWidgetCallback(axisSettingsWidget, AxisSettingsWidgetHandler);
+    }
+    else
+    {
+        // axis settings widget already created
+        if (!XPIsWidgetVisible(axisSettingsWidget))
+            XPShowWidget(axisSettingsWidget);
     }
+}
 
-    return 0;
+inline static float SmoothingFactor(float cutoff, float elapsedTime)
+{
+    const float timeConstant = 1.0f / (ONE_EURO_FILTER_TWO_PI * cutoff);
+    return 1.0f / (1.0f + timeConstant / elapsedTime);
 }
 
 static int SpeedbrakeModifierOrToggleCarbHeatCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
 {
     // if a speedbrake exists this command switches to speedbrake mode
-    if (XPLMGetDatai(acfSbrkEQDataRef))
+    if (aircraftProfile.hasSpeedbrake)
     {
         if (inPhase == xplm_CommandEnd)
         {
-            if (mode == SPEEDBRAKE)
-            {
-                // restore the default button assignments
-                PopButtonAssignments();
-
-                mode = DEFAULT;
-            }
-        }
-        else if (mode == DEFAULT)
-        {
-            mode = SPEEDBRAKE;
-
-            // store the default button assignments
-            PushButtonAssignments();
-
-            // assign trim controls to the buttons and dpad
-            int joystickButtonAssignments[1600];
-            XPLMGetDatavi(joystickButtonAssignmentsDataRef, joystickButtonAssignments, 0, 1600);
-
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_UP)] = (intptr_t)XPLMFindCommand("sim/flight_controls/speed_brakes_up_one");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_DOWN)] = (intptr_t)XPLMFindCommand("sim/flight_controls/speed_brakes_down_one");
-
-            XPLMSetDatavi(joystickButtonAssignmentsDataRef, joystickButtonAssignments, 0, 1600);
+            // restore the button assignments that were overridden by the speedbrake mode
+            PopModeLayer(SPEEDBRAKE);
         }
+        else if (CanPushModeLayer(SPEEDBRAKE))
+            // assign speedbrake controls to the face buttons
+            PushModeLayer(SPEEDBRAKE);
     }
     // if the aircraft is not equipped with a speedbrake this command toggles the carb heat
     else if (inPhase == xplm_CommandBegin)
-        XPLMCommandOnce(XPLMFindCommand("sim/engines/carb_heat_toggle"));
+        XPLMCommandOnce(GetCommand(COMMAND_ENGINES_CARB_HEAT_TOGGLE));
 
     return 0;
 }
@@ -3441,25 +5289,10 @@ static void ToggleKeyboardControl(int vrEnabled)
         return;
     }
 
-    if (mode == DEFAULT)
+    if (CanPushModeLayer(KEYBOARD))
     {
-        mode = KEYBOARD;
-
-        // store the default button assignments
-        PushButtonAssignments();
-
         // assign the keyboard selector and key commands
-        int joystickButtonAssignments[1600];
-        XPLMGetDatavi(joystickButtonAssignmentsDataRef, joystickButtonAssignments, 0, 1600);
-
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_UP)] = (intptr_t)XPLMFindCommand(KEYBOARD_SELECTOR_UP_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN)] = (intptr_t)XPLMFindCommand(KEYBOARD_SELECTOR_DOWN_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT)] = (intptr_t)XPLMFindCommand(KEYBOARD_SELECTOR_LEFT_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT)] = (intptr_t)XPLMFindCommand(KEYBOARD_SELECTOR_RIGHT_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_DOWN)] = (intptr_t)XPLMFindCommand(PRESS_KEYBOARD_KEY_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT)] = (intptr_t)XPLMFindCommand(LOCK_KEYBOARD_KEY_COMMAND);
-
-        XPLMSetDatavi(joystickButtonAssignmentsDataRef, joystickButtonAssignments, 0, 1600);
+        PushModeLayer(KEYBOARD);
 
         if (vrEnabled == -1)
             vrEnabled = XPLMGetDatai(vrEnabledDataRef);
@@ -3496,12 +5329,9 @@ static void ToggleKeyboardControl(int vrEnabled)
 static void ToggleMode(Mode m, XPLMCommandPhase phase)
 {
     if (phase == xplm_CommandEnd)
-    {
-        if (mode == m)
-            mode = DEFAULT;
-    }
-    else if (mode == DEFAULT)
-        mode = m;
+        PopModeLayer(m);
+    else if (CanPushModeLayer(m))
+        PushModeLayer(m);
 }
 
 static void ToggleMouseButton(MouseButton button, int down, void *display)
@@ -3570,35 +5400,15 @@ static void ToggleMouseControl(void)
         return;
     }
 
-    int joystickAxisAssignments[100];
-    XPLMGetDatavi(joystickAxisAssignmentsDataRef, joystickAxisAssignments, 0, 100);
-
-    if (mode == DEFAULT)
+    if (CanPushModeLayer(MOUSE))
     {
-        mode = MOUSE;
-
-        // assign no controls to the left joystick's axis since it will control the mouse pointer
-        joystickAxisAssignments[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)] = AXIS_ASSIGNMENT_NONE;
-        joystickAxisAssignments[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] = AXIS_ASSIGNMENT_NONE;
-
-        // store the default button assignments
-        PushButtonAssignments();
-
-        // assign the mouse button and scrolling commands
-        int joystickButtonAssignments[1600];
-        XPLMGetDatavi(joystickButtonAssignmentsDataRef, joystickButtonAssignments, 0, 1600);
-
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_DOWN)] = (intptr_t)XPLMFindCommand(TOGGLE_LEFT_MOUSE_BUTTON_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT)] = (intptr_t)XPLMFindCommand(TOGGLE_RIGHT_MOUSE_BUTTON_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_UP)] = (intptr_t)XPLMFindCommand(SCROLL_UP_COMMAND);
-        joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN)] = (intptr_t)XPLMFindCommand(SCROLL_DOWN_COMMAND);
-
-        XPLMSetDatavi(joystickButtonAssignmentsDataRef, joystickButtonAssignments, 0, 1600);
+        // assign no controls to the left joystick's axis since it will control the mouse pointer and assign the mouse button and scrolling commands
+        PushModeLayer(MOUSE);
 
         // temporarily gain exclusive camera controls
         OverrideCameraControls();
     }
-    else if (mode == MOUSE)
+    else if (IsModeActive(MOUSE))
     {
         // release both mouse buttons if they were still pressed while the mouse pointer control mode was turned off
 #if LIN
@@ -3609,26 +5419,18 @@ static void ToggleMouseControl(void)
         ToggleMouseButton(RIGHT, 0, NULL);
 #endif
 
-        // assign the default controls to the left joystick's axis
-        joystickAxisAssignments[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X)] = AXIS_ASSIGNMENT_YAW;
-        joystickAxisAssignments[AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y)] = AXIS_ASSIGNMENT_NONE;
-
-        // restore the default button assignments
-        PopButtonAssignments();
+        // restore the axis and button assignments that were overridden by the mouse mode
+        PopModeLayer(MOUSE);
 
         // restore camera controls
         RestoreCameraControls();
-
-        mode = DEFAULT;
     }
-
-    XPLMSetDatavi(joystickAxisAssignmentsDataRef, joystickAxisAssignments, 0, 100);
 }
 
 static int ToggleMouseOrKeyboardControlCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
 {
 #if LIN
-    if (controllerType == Xbox360)
+    if (settings.controllerType == XBOX360)
 #else
     if (!hidInitialized)
 #endif
@@ -3673,10 +5475,10 @@ static int ToggleReverseCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPha
         }
         else
         {
-            if (XPLMGetDatai(acfHasBetaDataRef))
+            if (aircraftProfile.hasBeta)
                 // has beta
                 XPLMSetDataf(throttleBetaRevRatioAllDataRef, THRUST_REVERSER_SETTING_ON_ENGAGEMENT);
-            else if (XPLMGetDatai(acfRevthrustEqDataRef))
+            else if (aircraftProfile.hasReverser)
             {
                 // has thrust reverser
                 XPLMSetDataf(throttleJetRevRatioAllDataRef, THRUST_REVERSER_SETTING_ON_ENGAGEMENT);
@@ -3698,149 +5500,319 @@ static int ToggleRightMouseButtonCommand(XPLMCommandRef inCommand, XPLMCommandPh
     return 0;
 }
 
+static void TrackCommandPhase(XPLMCommandRef command, XPLMCommandPhase phase)
+{
+    // keeps track of the commands that are currently held down, regardless of whether they were begun by us or by X-Plane's button handling
+    const int index = FindActiveCommand(command);
+    if (phase == xplm_CommandEnd)
+    {
+        if (index >= 0)
+            activeCommands[index] = activeCommands[--numActiveCommands];
+    }
+    else if (index < 0 && numActiveCommands < MAX_ACTIVE_COMMANDS)
+        activeCommands[numActiveCommands++] = command;
+}
+
 static int TrimModifierCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
 {
     if (inPhase == xplm_CommandEnd)
     {
-        if (mode == TRIM)
-        {
-            // restore the default button assignments
-            PopButtonAssignments();
-
-            // custom handling for DreamFoil AS350
-            if (IsPluginEnabled(DREAMFOIL_AS350_PLUGIN_SIGNATURE))
-                XPLMCommandEnd(XPLMFindCommand("AS350/Trim/Force_Trim"));
-            // custom handling for DreamFoil B407
-            else if (IsPluginEnabled(DREAMFOIL_B407_PLUGIN_SIGNATURE))
-                XPLMCommandEnd(XPLMFindCommand("B407/flight_controls/force_trim"));
-
-            mode = DEFAULT;
-        }
+        // restore the button assignments that were overridden by the trim mode
+        if (PopModeLayer(TRIM) && modeOverlayTable.forceTrimCommand)
+            EndCommand(modeOverlayTable.forceTrimCommand);
     }
-    else if (mode == DEFAULT)
+    else if (CanPushModeLayer(TRIM))
     {
-        mode = TRIM;
-
-        // store the default button assignments
-        PushButtonAssignments();
+        // custom handling for DreamFoil AS350 and B407
+        if (modeOverlayTable.forceTrimCommand)
+            BeginCommand(modeOverlayTable.forceTrimCommand);
 
         // assign trim controls to the buttons and dpad
-        int joystickButtonAssignments[1600];
-        XPLMGetDatavi(joystickButtonAssignmentsDataRef, joystickButtonAssignments, 0, 1600);
+        PushModeLayer(TRIM);
+    }
+
+    return 0;
+}
 
+static int TrimResetCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
+{
+    if (inPhase == xplm_CommandBegin)
+    {
         // custom handling for DreamFoil AS350
-        if (IsPluginEnabled(DREAMFOIL_AS350_PLUGIN_SIGNATURE))
+        if (IsPluginEnabled(PLUGIN_DREAMFOIL_AS350))
         {
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_LEFT)] = (intptr_t)XPLMFindCommand("sim/flight_controls/rudder_trim_left");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT)] = (intptr_t)XPLMFindCommand("sim/flight_controls/rudder_trim_right");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_CENTER_LEFT)] = (intptr_t)XPLMFindCommand(TRIM_RESET_COMMAND);
-
-            XPLMCommandBegin(XPLMFindCommand("AS350/Trim/Force_Trim"));
+            EndCommand(GetCommand(COMMAND_AS350_FORCE_TRIM));
+            XPLMCommandOnce(GetCommand(COMMAND_AS350_TRIM_RELEASE));
         }
         // custom handling for DreamFoil B407
-        else if (IsPluginEnabled(DREAMFOIL_B407_PLUGIN_SIGNATURE))
-        {
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_LEFT)] = (intptr_t)XPLMFindCommand("sim/flight_controls/rudder_trim_left");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT)] = (intptr_t)XPLMFindCommand("sim/flight_controls/rudder_trim_right");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_CENTER_LEFT)] = (intptr_t)XPLMFindCommand(TRIM_RESET_COMMAND);
-
-            XPLMCommandBegin(XPLMFindCommand("B407/flight_controls/force_trim"));
-        }
-        // custom handling for RotorSim EC135
-        else if (IsPluginEnabled(ROTORSIM_EC135_PLUGIN_SIGNATURE))
+        else if (IsPluginEnabled(PLUGIN_DREAMFOIL_B407))
         {
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT)] = (intptr_t)XPLMFindCommand("ec135/autopilot/beep_left");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT)] = (intptr_t)XPLMFindCommand("ec135/autopilot/beep_right");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_UP)] = (intptr_t)XPLMFindCommand("ec135/autopilot/beep_fwd");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN)] = (intptr_t)XPLMFindCommand("ec135/autopilot/beep_aft");
+            EndCommand(GetCommand(COMMAND_B407_FORCE_TRIM));
+            XPLMCommandOnce(GetCommand(COMMAND_B407_TRIM_RELEASE));
         }
-        // default handling
         else
         {
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT)] = (intptr_t)XPLMFindCommand("sim/flight_controls/aileron_trim_left");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT)] = (intptr_t)XPLMFindCommand("sim/flight_controls/aileron_trim_right");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_UP)] = (intptr_t)XPLMFindCommand("sim/flight_controls/pitch_trim_down");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN)] = (intptr_t)XPLMFindCommand("sim/flight_controls/pitch_trim_up");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_LEFT)] = (intptr_t)XPLMFindCommand("sim/flight_controls/rudder_trim_left");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT)] = (intptr_t)XPLMFindCommand("sim/flight_controls/rudder_trim_right");
-            joystickButtonAssignments[ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_CENTER_LEFT)] = (intptr_t)XPLMFindCommand(TRIM_RESET_COMMAND);
+            XPLMCommandOnce(GetCommand(COMMAND_FLIGHT_CONTROLS_AILERON_TRIM_CENTER));
+            XPLMCommandOnce(GetCommand(COMMAND_FLIGHT_CONTROLS_RUDDER_TRIM_CENTER));
         }
 
-        XPLMSetDatavi(joystickButtonAssignmentsDataRef, joystickButtonAssignments, 0, 1600);
+        XPLMCommandOnce(GetCommand(COMMAND_FLIGHT_CONTROLS_RUDDER_TRIM_CENTER));
     }
 
     return 0;
 }
 
-static int TrimResetCommand(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon)
+static void UnclaimDispatchButtons(void)
 {
-    if (inPhase == xplm_CommandBegin)
+    if (dispatchWindowCount <= 0)
+        return;
+
+    ReleaseDispatchedButtons();
+
+    XPLMSetDatavi(joystickButtonAssignmentsDataRef, dispatchSavedAssignments, dispatchWindowStart, dispatchWindowCount);
+    dispatchWindowStart = -1;
+    dispatchWindowCount = 0;
+}
+
+static void UpdateAircraftProfile(void)
+{
+    AircraftProfile profile = {0};
+
+    profile.numEngines = XPLMGetDatai(acfNumEnginesDataRef);
+    if (profile.numEngines > 8)
+        profile.numEngines = 8;
+
+    XPLMGetDatavi(acfEnTypeDataRef, profile.enType, 0, 8);
+    XPLMGetDatavi(acfPropTypeDataRef, profile.propType, 0, 8);
+    XPLMGetDatavf(acfMinPitchDataRef, profile.minPitch, 0, 8);
+    XPLMGetDatavf(acfMaxPitchDataRef, profile.maxPitch, 0, 8);
+    profile.rscRedlinePrp = XPLMGetDataf(acfRSCRedlinePrpDataRef);
+    profile.featheredPitch = XPLMGetDataf(acfFeatheredPitchDataRef);
+
+    profile.helicopter = XPLMGetDatai(acfCockpitTypeDataRef) == 5;
+    for (int i = 0; i < profile.numEngines && !profile.helicopter; i++)
     {
-        // custom handling for DreamFoil AS350
-        if (IsPluginEnabled(DREAMFOIL_AS350_PLUGIN_SIGNATURE))
+        if (profile.propType[i] == 3)
+            profile.helicopter = 1;
+    }
+
+    profile.hasSpeedbrake = XPLMGetDatai(acfSbrkEQDataRef);
+    profile.gliderWithSpeedbrakes = profile.numEngines < 1 && profile.hasSpeedbrake;
+    profile.hasBeta = XPLMGetDatai(acfHasBetaDataRef);
+    profile.hasReverser = XPLMGetDatai(acfRevthrustEqDataRef);
+
+    // this requires reading the '.acf' file, so it is only done once when the aircraft is loaded
+    profile.has2DPanel = Has2DPanel();
+
+    if (profile.hasBeta)
+        profile.throttleRatioDataRef = throttleBetaRevRatioAllDataRef;
+    else if (profile.hasReverser)
+        profile.throttleRatioDataRef = throttleJetRevRatioAllDataRef;
+    else
+        profile.throttleRatioDataRef = throttleRatioAllDataRef;
+
+    char acfICAO[40];
+    XPLMGetDatab(acfICAODataRef, acfICAO, 0, 40);
+    acfICAO[39] = '\0';
+
+    if (!profile.gliderWithSpeedbrakes && strcmp(acfICAO, DA_62_ICAO_CODE) != 0)
+    {
+        for (int i = 0; i < profile.numEngines; i++)
         {
-            XPLMCommandEnd(XPLMFindCommand("AS350/Trim/Force_Trim"));
-            XPLMCommandOnce(XPLMFindCommand("AS350/Trim/Trim_Release"));
+            if (profile.propType[i] >= 1 && profile.propType[i] <= 3)
+                profile.numPropLevers++;
+
+            if (profile.enType[i] < 2 || (profile.enType[i] == 2 && !profile.helicopter) || profile.enType[i] == 8)
+                profile.numMixtureLevers++;
         }
-        // custom handling for DreamFoil B407
-        else if (IsPluginEnabled(DREAMFOIL_B407_PLUGIN_SIGNATURE))
+    }
+
+    aircraftProfile = profile;
+
+    CompileAxisBindings();
+
+    modeOverlaysStale = 1;
+    UpdateModeOverlays();
+}
+
+inline static int UpdateAxisLiveness(AxisCalibrationState *state, float value)
+{
+    // axes can get initialized with a value of exactly 0.0 or 1.0 if they haven't been moved yet - an axis only becomes live once it reports a value from within the range, which also rejects nan
+    if (!state->live && value > 0.0f && value < 1.0f)
+    {
+        state->live = 1;
+        state->restAnchor = value;
+    }
+
+    return state->live;
+}
+
+static void UpdateAxisSettingsWidgets(void)
+{
+    if (axisSettingsWidget == NULL)
+        return;
+
+    for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
+    {
+        const CurveType curveType = settings.axisCurves[i].type;
+        XPSetWidgetDescriptor(curveTypeButtons[i], curveType >= CURVE_LINEAR && curveType < NUM_CURVE_TYPES ? curveTypeNames[curveType] : "");
+        XPSetWidgetProperty(curvePointsTextFields[i], xpProperty_Enabled, (intptr_t)(curveType == CURVE_CUSTOM));
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        const DeadzoneConfig *deadzoneConfig = &settings.stickDeadzones[i];
+        XPSetWidgetDescriptor(deadzoneTypeButtons[i], deadzoneConfig->type == DEADZONE_RADIAL ? "Radial" : "Axial");
+
+        // a negative inner deadzone stands for X-Plane's nullzone and a negative anti-deadzone for the inner deadzone
+        const float values[3] = {deadzoneConfig->inner, deadzoneConfig->outer, deadzoneConfig->antiDeadzone};
+        for (int j = 0; j < 3; j++)
         {
-            XPLMCommandEnd(XPLMFindCommand("B407/flight_controls/force_trim"));
-            XPLMCommandOnce(XPLMFindCommand("B407/flight_controls/trim_release"));
+            const int position = values[j] < 0.0f ? -1 : (int)(values[j] * 100.0f + 0.5f);
+            XPSetWidgetProperty(deadzoneSliders[i][j], xpProperty_ScrollBarSliderPosition, position);
+
+            char text[16];
+            if (position < 0)
+                snprintf(text, sizeof text, "%s", j == 0 ? "Nullzone" : "Inner");
+            else
+                snprintf(text, sizeof text, "%d%%", position);
+            XPSetWidgetDescriptor(deadzoneValueCaptions[i][j], text);
         }
-        else
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        const FilterConfig *filterConfig = &settings.axisFilters[i];
+        const float values[2] = {filterConfig->minCutoff, filterConfig->beta};
+        for (int j = 0; j < 2; j++)
         {
-            XPLMCommandOnce(XPLMFindCommand("sim/flight_controls/aileron_trim_center"));
-            XPLMCommandOnce(XPLMFindCommand("sim/flight_controls/rudder_trim_center"));
+            XPSetWidgetProperty(filterSliders[i][j], xpProperty_ScrollBarSliderPosition, (intptr_t)(values[j] * 10.0f + 0.5f));
+
+            char text[16];
+            snprintf(text, sizeof text, j == 0 ? "%.1f Hz" : "%.1f", values[j]);
+            XPSetWidgetDescriptor(filterValueCaptions[i][j], text);
         }
+    }
+
+    XPSetWidgetDescriptor(bindingsModeButton, modeNames[bindingsMode]);
+
+    for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
+    {
+        // only the widgets of a bound axis are enabled and the bounds can only be set while they are custom
+        const AxisBinding *axisBinding = FindAxisBinding(bindingsMode, i);
+        const int bound = axisBinding != NULL && axisBinding->actuator >= ACTUATOR_POWER && axisBinding->actuator < NUM_ACTUATORS;
+        const int customBounds = bound && axisBinding->boundsSource == BOUNDS_CUSTOM;
+
+        XPSetWidgetDescriptor(actuatorButtons[i], bound ? actuatorNames[axisBinding->actuator] : "None");
+
+        XPSetWidgetDescriptor(bindingCurveButtons[i], bound && axisBinding->curve >= 0 && axisBinding->curve < NUM_ABSTRACT_AXES ? axisNames[axisBinding->curve] : "");
+        XPSetWidgetProperty(bindingCurveButtons[i], xpProperty_Enabled, bound);
+
+        XPSetWidgetProperty(invertCheckboxes[i], xpProperty_ButtonState, bound && axisBinding->rate * axisDirections[i] < 0.0f);
+        XPSetWidgetProperty(invertCheckboxes[i], xpProperty_Enabled, bound);
+
+        XPSetWidgetProperty(customBoundsCheckboxes[i], xpProperty_ButtonState, customBounds);
+        XPSetWidgetProperty(customBoundsCheckboxes[i], xpProperty_Enabled, bound);
+
+        const float values[2] = {bound ? axisBinding->minimum : 0.0f, bound ? axisBinding->maximum : 1.0f};
+        for (int j = 0; j < 2; j++)
+        {
+            const int position = (int)(values[j] * 100.0f + 0.5f);
+            XPSetWidgetProperty(boundsSliders[i][j], xpProperty_ScrollBarSliderPosition, position);
+            XPSetWidgetProperty(boundsSliders[i][j], xpProperty_Enabled, customBounds);
 
-        XPLMCommandOnce(XPLMFindCommand("sim/flight_controls/rudder_trim_center"));
+            char text[16];
+            if (customBounds)
+                snprintf(text, sizeof text, "%d%%", position);
+            else
+                text[0] = '\0';
+            XPSetWidgetDescriptor(boundsValueCaptions[i][j], text);
+        }
     }
+}
 
-    return 0;
+static void UpdateButtonDispatch(void)
+{
+    // the mode layers remember the assignments they replaced, so the buttons are only claimed or handed back while no layer is active
+    if (numModeLayers > 0)
+        return;
+
+    // without a dispatch window the buttons are left to X-Plane's assignments
+    const int dispatch = settings.directButtonDispatch && modeOverlayTable.buttonWindowCount > 0;
+    if (dispatchWindowCount > 0 && (!dispatch || dispatchWindowStart != modeOverlayTable.buttonWindowStart || dispatchWindowCount != modeOverlayTable.buttonWindowCount))
+        UnclaimDispatchButtons();
+
+    if (dispatch && dispatchWindowCount <= 0)
+        ClaimDispatchButtons();
 }
 
-static void UpdateIndicatorsWindow(int vrEnabled)
+static void UpdateEnabledPlugins(void)
 {
-    if (indicatorsWindow)
+    unsigned int plugins = 0;
+    for (int i = 0; i < NUM_PLUGINS; i++)
     {
-        XPLMDestroyWindow(indicatorsWindow);
-        indicatorsWindow = NULL;
+        if (XPLMIsPluginEnabled(XPLMFindPluginBySignature(pluginSignatures[i])))
+            plugins |= 1u << i;
     }
 
-    const int acfNumEngines = XPLMGetDatai(acfNumEnginesDataRef);
-    const int gliderWithSpeedbrakes = IsGliderWithSpeedbrakes();
+    // the datarefs of a plugin that was just enabled or disabled have appeared or vanished
+    if (plugins != enabledPlugins)
+        thirdPartyDataRefsStale = 1;
+
+    enabledPlugins = plugins;
+}
 
-    if (!settings.showIndicators || (acfNumEngines < 1 && !gliderWithSpeedbrakes))
+static void UpdateFrameState(void)
+{
+    // the flight loop and the drawing callback both need these values, so we only read the datarefs once per sim cycle
+    const int cycleNumber = XPLMGetCycleNumber();
+    if (cycleNumber == frameState.cycleNumber)
         return;
 
-    char acfICAO[40];
-    XPLMGetDatab(acfICAODataRef, acfICAO, 0, 40);
+    frameState.cycleNumber = cycleNumber;
+    frameState.hasJoystick = XPLMGetDatai(hasJoystickDataRef);
+    frameState.viewType = XPLMGetDatai(viewTypeDataRef);
+    frameState.paused = XPLMGetDatai(pausedDataRef);
+    frameState.joystickPitchNullzone = XPLMGetDataf(joystickPitchNullzoneDataRef);
+}
+
+static void UpdateIndicatorValues(void)
+{
+    if (aircraftProfile.gliderWithSpeedbrakes)
+        indicatorValues.throttle = 1.0f - XPLMGetDataf(speedbrakeRatioDataRef);
+    else
+        indicatorValues.throttle = GetThrottleRatio(throttleBetaRevRatioAllDataRef);
 
-    numPropLevers = 0;
-    numMixtureLevers = 0;
-    if (!gliderWithSpeedbrakes && strcmp(acfICAO, DA_62_ICAO_CODE) != 0)
+    if (aircraftProfile.numPropLevers < 1)
+        indicatorValues.prop = -3.0f;
+    else if (aircraftProfile.helicopter)
     {
-        const int helicopter = IsHelicopter();
+        float propPitchDeg = 0.0f;
+        XPLMGetDatavf(propPitchDegDataRef, &propPitchDeg, 0, 1);
 
-        int acfPropType[8];
-        XPLMGetDatavi(acfPropTypeDataRef, acfPropType, 0, 8);
-        int acfEnType[8];
-        XPLMGetDatavi(acfEnTypeDataRef, acfEnType, 0, 8);
-        for (int i = 0; i < acfNumEngines; i++)
-        {
-            if (acfPropType[i] >= 1 && acfPropType[i] <= 3)
-                numPropLevers++;
+        indicatorValues.prop = Normalize(propPitchDeg, aircraftProfile.minPitch[0], aircraftProfile.maxPitch[0], 0.0f, 1.0f);
+    }
+    else
+        indicatorValues.prop = Normalize(XPLMGetDataf(propRotationSpeedRadSecAllDataRef), aircraftProfile.featheredPitch, aircraftProfile.rscRedlinePrp, 0.0f, 1.0f);
 
-            if (acfEnType[i] < 2 || (acfEnType[i] == 2 && !helicopter) || acfEnType[i] == 8)
-                numMixtureLevers++;
-        }
+    indicatorValues.mixture = aircraftProfile.numMixtureLevers < 1 ? -3.0f : XPLMGetDataf(mixtureRatioAllDataRef);
+}
+
+static void UpdateIndicatorsWindow(int vrEnabled)
+{
+    if (indicatorsWindow)
+    {
+        XPLMDestroyWindow(indicatorsWindow);
+        indicatorsWindow = NULL;
     }
 
+    if (!settings.showIndicators || (aircraftProfile.numEngines < 1 && !aircraftProfile.gliderWithSpeedbrakes))
+        return;
+
     int width = INDICATOR_LEVER_WIDTH;
-    if (numPropLevers > 0)
+    if (aircraftProfile.numPropLevers > 0)
         width += INDICATOR_LEVER_WIDTH;
-    if (numMixtureLevers > 0)
+    if (aircraftProfile.numMixtureLevers > 0)
         width += INDICATOR_LEVER_WIDTH;
 
     if (vrEnabled == -1)
@@ -3867,6 +5839,231 @@ static void UpdateIndicatorsWindow(int vrEnabled)
     XPLMSetWindowPositioningMode(indicatorsWindow, vrEnabled ? xplm_WindowVR : xplm_WindowPositionFree, 0);
 }
 
+#if LIN
+static void UpdateInputThreadConfig(void)
+{
+    // the input thread must not read the settings while we may overwrite them, so it gets its own copy of the parts it needs whenever they change
+    InputThreadConfig config = {0};
+    config.rate = settings.inputThreadRate;
+    memcpy(config.axisFilters, settings.axisFilters, sizeof config.axisFilters);
+
+    if (memcmp(&config, &inputThreadConfig, sizeof config) == 0)
+        return;
+
+    pthread_mutex_lock(&inputThreadConfigMutex);
+    inputThreadConfig = config;
+    pthread_mutex_unlock(&inputThreadConfigMutex);
+
+    atomic_fetch_add_explicit(&inputThreadConfigVersion, 1, memory_order_release);
+}
+#endif
+
+static void UpdateModeOverlays(void)
+{
+    if (!modeOverlaysStale && modeOverlayTable.controllerType == settings.controllerType && modeOverlayTable.axisOffset == settings.axisOffset && modeOverlayTable.buttonOffset == settings.buttonOffset && modeOverlayTable.enabledPlugins == enabledPlugins)
+        return;
+
+    ModeOverlayTable table = {0};
+    table.controllerType = settings.controllerType;
+    table.axisOffset = settings.axisOffset;
+    table.buttonOffset = settings.buttonOffset;
+    table.enabledPlugins = enabledPlugins;
+
+    // default mode: the assignments that are in effect while no modifier is held down
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT), GetCommand(COMMAND_FLIGHT_CONTROLS_FLAPS_UP));
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT), GetCommand(COMMAND_FLIGHT_CONTROLS_FLAPS_DOWN));
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_UP), toggleArmSpeedBrakeOrToggleCarbHeatCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN), GetCommand(COMMAND_FLIGHT_CONTROLS_LANDING_GEAR_TOGGLE));
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT_UP), GetCommand(COMMAND_NONE));
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT_DOWN), GetCommand(COMMAND_NONE));
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT_UP), GetCommand(COMMAND_NONE));
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT_DOWN), GetCommand(COMMAND_NONE));
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_LEFT), cycleResetViewCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT), mixtureControlModifierCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_UP), propPitchOrThrottleModifierCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_DOWN), cowlFlapModifierCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_CENTER_LEFT), toggleReverseCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_CENTER_RIGHT), GetCommand(COMMAND_FLIGHT_CONTROLS_BRAKES_TOGGLE_MAX));
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_BUMPER_LEFT), trimModifierCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_BUMPER_RIGHT), lookModifierCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_STICK_LEFT), GetCommand(COMMAND_GENERAL_ZOOM_OUT));
+    AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_STICK_RIGHT), GetCommand(COMMAND_GENERAL_ZOOM_IN));
+    switch (settings.controllerType)
+    {
+    case XBOX360:
+#if !IBM
+        AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], JOYSTICK_BUTTON_XBOX360_GUIDE + settings.buttonOffset, toggleMousePointerControlCommand);
+#endif
+        break;
+    case DS4:
+        AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], JOYSTICK_BUTTON_DS4_L2 + settings.buttonOffset, GetCommand(COMMAND_NONE));
+        AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], JOYSTICK_BUTTON_DS4_R2 + settings.buttonOffset, GetCommand(COMMAND_NONE));
+        AddButtonOverlayEntry(&table.buttonOverlays[DEFAULT], JOYSTICK_BUTTON_DS4_PS + settings.buttonOffset, toggleMousePointerControlCommand);
+        break;
+    }
+
+    // all modes: unassign the axes that drive an actuator in the mode, the assignments of the default mode are handled by SetDefaultAssignments
+    for (int m = DEFAULT + 1; m < NUM_MODES; m++)
+    {
+        for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
+        {
+            if (compiledAxisBindings[m][i].handler)
+                AddAxisOverlayEntry(&table.axisOverlays[m], AxisIndex(i), AXIS_ASSIGNMENT_NONE);
+        }
+    }
+
+    // look mode: unassign the left joystick's axis
+    AddAxisOverlayEntry(&table.axisOverlays[LOOK], AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X), AXIS_ASSIGNMENT_NONE);
+    AddAxisOverlayEntry(&table.axisOverlays[LOOK], AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y), AXIS_ASSIGNMENT_NONE);
+
+    // look mode: assign panel scrolling controls to the dpad
+    AddButtonOverlayEntry(&table.buttonOverlays[LOOK], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT), GetCommand(COMMAND_GENERAL_LEFT));
+    AddButtonOverlayEntry(&table.buttonOverlays[LOOK], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT), GetCommand(COMMAND_GENERAL_RIGHT));
+    AddButtonOverlayEntry(&table.buttonOverlays[LOOK], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_UP), GetCommand(COMMAND_GENERAL_UP));
+    AddButtonOverlayEntry(&table.buttonOverlays[LOOK], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN), GetCommand(COMMAND_GENERAL_DOWN));
+    AddButtonOverlayEntry(&table.buttonOverlays[LOOK], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_LEFT), GetCommand(COMMAND_GENERAL_ROT_LEFT));
+    AddButtonOverlayEntry(&table.buttonOverlays[LOOK], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT), GetCommand(COMMAND_GENERAL_ROT_RIGHT));
+    AddButtonOverlayEntry(&table.buttonOverlays[LOOK], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_UP), GetCommand(COMMAND_GENERAL_FORWARD));
+    AddButtonOverlayEntry(&table.buttonOverlays[LOOK], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_DOWN), GetCommand(COMMAND_GENERAL_BACKWARD));
+
+    // look mode: unassign the DS4 triggers and assign push-to-talk and autopilot controls to them instead
+    if (settings.controllerType == DS4)
+    {
+        AddAxisOverlayEntry(&table.axisOverlays[LOOK], JOYSTICK_AXIS_DS4_L2 + settings.axisOffset, AXIS_ASSIGNMENT_NONE);
+        AddAxisOverlayEntry(&table.axisOverlays[LOOK], JOYSTICK_AXIS_DS4_R2 + settings.axisOffset, AXIS_ASSIGNMENT_NONE);
+        AddButtonOverlayEntry(&table.buttonOverlays[LOOK], JOYSTICK_BUTTON_DS4_L2 + settings.buttonOffset, pushToTalkCommand);
+        AddButtonOverlayEntry(&table.buttonOverlays[LOOK], JOYSTICK_BUTTON_DS4_R2 + settings.buttonOffset, cwsOrDisconnectAutopilotCommand);
+    }
+
+    // switch view mode: assign view controls to the dpad
+    AddButtonOverlayEntry(&table.buttonOverlays[SWITCH_VIEW], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT), GetCommand(COMMAND_VIEW_CHASE));
+    AddButtonOverlayEntry(&table.buttonOverlays[SWITCH_VIEW], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT), GetCommand(COMMAND_VIEW_FORWARD_WITH_HUD));
+    AddButtonOverlayEntry(&table.buttonOverlays[SWITCH_VIEW], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_UP), GetCommand(aircraftProfile.has2DPanel ? COMMAND_VIEW_FORWARD_WITH_2D_PANEL : COMMAND_VIEW_3D_COCKPIT_COMMAND_LOOK));
+    AddButtonOverlayEntry(&table.buttonOverlays[SWITCH_VIEW], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN), GetCommand(aircraftProfile.has2DPanel ? COMMAND_VIEW_3D_COCKPIT_COMMAND_LOOK : COMMAND_VIEW_FORWARD_WITH_2D_PANEL));
+
+    // trim mode: assign trim controls to the buttons and dpad
+    // custom handling for DreamFoil AS350 and B407
+    if (IsPluginEnabled(PLUGIN_DREAMFOIL_AS350) || IsPluginEnabled(PLUGIN_DREAMFOIL_B407))
+    {
+        AddButtonOverlayEntry(&table.buttonOverlays[TRIM], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_LEFT), GetCommand(COMMAND_FLIGHT_CONTROLS_RUDDER_TRIM_LEFT));
+        AddButtonOverlayEntry(&table.buttonOverlays[TRIM], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT), GetCommand(COMMAND_FLIGHT_CONTROLS_RUDDER_TRIM_RIGHT));
+        AddButtonOverlayEntry(&table.buttonOverlays[TRIM], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_CENTER_LEFT), trimResetCommand);
+
+        table.forceTrimCommand = GetCommand(IsPluginEnabled(PLUGIN_DREAMFOIL_AS350) ? COMMAND_AS350_FORCE_TRIM : COMMAND_B407_FORCE_TRIM);
+    }
+    // custom handling for RotorSim EC135
+    else if (IsPluginEnabled(PLUGIN_ROTORSIM_EC135))
+    {
+        AddButtonOverlayEntry(&table.buttonOverlays[TRIM], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT), GetCommand(COMMAND_EC135_BEEP_LEFT));
+        AddButtonOverlayEntry(&table.buttonOverlays[TRIM], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT), GetCommand(COMMAND_EC135_BEEP_RIGHT));
+        AddButtonOverlayEntry(&table.buttonOverlays[TRIM], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_UP), GetCommand(COMMAND_EC135_BEEP_FWD));
+        AddButtonOverlayEntry(&table.buttonOverlays[TRIM], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN), GetCommand(COMMAND_EC135_BEEP_AFT));
+    }
+    // default handling
+    else
+    {
+        AddButtonOverlayEntry(&table.buttonOverlays[TRIM], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT), GetCommand(COMMAND_FLIGHT_CONTROLS_AILERON_TRIM_LEFT));
+        AddButtonOverlayEntry(&table.buttonOverlays[TRIM], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT), GetCommand(COMMAND_FLIGHT_CONTROLS_AILERON_TRIM_RIGHT));
+        AddButtonOverlayEntry(&table.buttonOverlays[TRIM], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_UP), GetCommand(COMMAND_FLIGHT_CONTROLS_PITCH_TRIM_DOWN));
+        AddButtonOverlayEntry(&table.buttonOverlays[TRIM], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN), GetCommand(COMMAND_FLIGHT_CONTROLS_PITCH_TRIM_UP));
+        AddButtonOverlayEntry(&table.buttonOverlays[TRIM], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_LEFT), GetCommand(COMMAND_FLIGHT_CONTROLS_RUDDER_TRIM_LEFT));
+        AddButtonOverlayEntry(&table.buttonOverlays[TRIM], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT), GetCommand(COMMAND_FLIGHT_CONTROLS_RUDDER_TRIM_RIGHT));
+        AddButtonOverlayEntry(&table.buttonOverlays[TRIM], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_CENTER_LEFT), trimResetCommand);
+    }
+
+    // speedbrake mode: assign speedbrake controls to the face buttons
+    AddButtonOverlayEntry(&table.buttonOverlays[SPEEDBRAKE], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_UP), GetCommand(COMMAND_FLIGHT_CONTROLS_SPEED_BRAKES_UP_ONE));
+    AddButtonOverlayEntry(&table.buttonOverlays[SPEEDBRAKE], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_DOWN), GetCommand(COMMAND_FLIGHT_CONTROLS_SPEED_BRAKES_DOWN_ONE));
+
+    // mouse mode: assign no controls to the left joystick's axis since it will control the mouse pointer
+    AddAxisOverlayEntry(&table.axisOverlays[MOUSE], AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_X), AXIS_ASSIGNMENT_NONE);
+    AddAxisOverlayEntry(&table.axisOverlays[MOUSE], AxisIndex(JOYSTICK_AXIS_ABSTRACT_LEFT_Y), AXIS_ASSIGNMENT_NONE);
+
+    // mouse mode: assign the mouse button and scrolling commands
+    AddButtonOverlayEntry(&table.buttonOverlays[MOUSE], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_DOWN), toggleLeftMouseButtonCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[MOUSE], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT), toggleRightMouseButtonCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[MOUSE], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_UP), scrollUpCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[MOUSE], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN), scrollDownCommand);
+
+    // keyboard mode: assign the keyboard selector and key commands
+    AddButtonOverlayEntry(&table.buttonOverlays[KEYBOARD], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_UP), keyboardSelectorUpCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[KEYBOARD], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_DOWN), keyboardSelectorDownCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[KEYBOARD], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_LEFT), keyboardSelectorLeftCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[KEYBOARD], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_DPAD_RIGHT), keyboardSelectorRightCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[KEYBOARD], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_DOWN), pressKeyboardKeyCommand);
+    AddButtonOverlayEntry(&table.buttonOverlays[KEYBOARD], ButtonIndex(JOYSTICK_BUTTON_ABSTRACT_FACE_RIGHT), lockKeyboardKeyCommand);
+
+    // the window of the button values array that covers all buttons of all modes, this is what the direct dispatch reads each frame
+    int first = NUM_JOYSTICK_BUTTONS, last = -1;
+    for (int m = 0; m < NUM_MODES; m++)
+    {
+        for (int i = 0; i < table.buttonOverlays[m].numEntries; i++)
+        {
+            const int index = table.buttonOverlays[m].entries[i].index;
+            if (index < first)
+                first = index;
+            if (index > last)
+                last = index;
+        }
+    }
+    if (last >= first && last - first < MAX_DISPATCH_BUTTONS)
+    {
+        table.buttonWindowStart = first;
+        table.buttonWindowCount = last - first + 1;
+    }
+    else if (settings.directButtonDispatch)
+        XPLMDebugString(NAME ": The buttons of the controller are spread too far for direct button dispatch, falling back to button assignments\n");
+
+    modeOverlayTable = table;
+
+    // the force trim command of the DreamFoil helicopters might not have been created yet, in that case we compile the overlays again during the next housekeeping cycles - but only for a limited number of times, since it might never appear
+    if ((IsPluginEnabled(PLUGIN_DREAMFOIL_AS350) || IsPluginEnabled(PLUGIN_DREAMFOIL_B407)) && table.forceTrimCommand == NULL && ++modeOverlayRetries < MAX_MODE_OVERLAY_RETRIES)
+        modeOverlaysStale = 1;
+    else
+    {
+        modeOverlaysStale = 0;
+        modeOverlayRetries = 0;
+    }
+}
+
+static void UpdateReadPlan(void)
+{
+    if (readPlan.axisCount > 0 && readPlan.controllerType == settings.controllerType && readPlan.axisOffset == settings.axisOffset)
+        return;
+
+    readPlan.controllerType = settings.controllerType;
+    readPlan.axisOffset = settings.axisOffset;
+
+    // find the smallest window of the axis values array that covers all axes evaluated by the flight loop
+    int first = 100, last = -1;
+    for (int i = 0; i < NUM_ABSTRACT_AXES; i++)
+    {
+        const int axisIndex = AxisIndex(i);
+        if (axisIndex < 0 || axisIndex >= 100)
+            continue;
+
+        if (axisIndex < first)
+            first = axisIndex;
+        if (axisIndex > last)
+            last = axisIndex;
+    }
+
+    readPlan.axisStart = last < first ? 0 : first;
+    readPlan.axisCount = last < first ? 0 : last - first + 1;
+}
+
+static void UpdateResponseCurve(ResponseCurve *responseCurve, const CurveConfig *curveConfig)
+{
+    // the table only needs to be rebuilt if the curve configuration has changed
+    if (responseCurve->valid && !memcmp(&responseCurve->config, curveConfig, sizeof(CurveConfig)))
+        return;
+
+    responseCurve->config = *curveConfig;
+    for (int i = 0; i <= RESPONSE_CURVE_TABLE_SIZE; i++)
+        responseCurve->table[i] = CurveValue(curveConfig, (float)i / RESPONSE_CURVE_TABLE_SIZE);
+    responseCurve->valid = 1;
+}
+
 static void UpdateSettingsWidgets(void)
 {
     XPSetWidgetProperty(xbox360ControllerRadioButton, xpProperty_ButtonState, (intptr_t)(settings.controllerType == XBOX360));
@@ -3897,6 +6094,9 @@ static void UpdateSettingsWidgets(void)
     XPSetWidgetProperty(configurationStatusCaption, xpProperty_CaptionLit, (intptr_t)(configurationStep != START));
     XPSetWidgetDescriptor(startConfigurationtButton, configurationStep == AXES || configurationStep == BUTTONS ? "Abort Configuration" : "Start Configuration");
     XPSetWidgetProperty(showIndicatorsCheckbox, xpProperty_ButtonState, (intptr_t)settings.showIndicators);
+    XPSetWidgetProperty(smoothStickInputCheckbox, xpProperty_ButtonState, (intptr_t)settings.axisFilters[0].enabled);
+    XPSetWidgetProperty(directInputCheckbox, xpProperty_ButtonState, (intptr_t)settings.directInput);
+    XPSetWidgetProperty(directButtonDispatchCheckbox, xpProperty_ButtonState, (intptr_t)settings.directButtonDispatch);
 }
 
 static void UpdateToeBrakeControl(void)
@@ -3904,6 +6104,99 @@ static void UpdateToeBrakeControl(void)
     XPLMSetDatai(overrideToeBrakesDataRef, settings.controllerType == XBOX360);
 }
 
+static int UpdateTriggers(float leftTrigger, float rightTrigger)
+{
+    static int prevLookActive = 0, prevLeftTriggerDown = 0, prevRightTriggerDown = 0;
+    const int lookActive = IsModeActive(LOOK);
+    const int leftTriggerDown = leftTrigger > TRIGGER_THRESHOLD;
+    const int rightTriggerDown = rightTrigger > TRIGGER_THRESHOLD;
+
+    const int active = leftTriggerDown || rightTriggerDown || prevLeftTriggerDown || prevRightTriggerDown;
+
+    float leftBrakeRatio = 0.0f, rightBrakeRatio = 0.0f;
+
+    if (lookActive)
+    {
+        if (leftTriggerDown && !prevLeftTriggerDown)
+            BeginCommand(pushToTalkCommand);
+        else if (!leftTriggerDown && prevLeftTriggerDown)
+            EndCommand(pushToTalkCommand);
+
+        if (rightTriggerDown && !prevRightTriggerDown)
+            BeginCommand(cwsOrDisconnectAutopilotCommand);
+        else if (!rightTriggerDown && prevRightTriggerDown)
+            EndCommand(cwsOrDisconnectAutopilotCommand);
+    }
+    else
+    {
+        if (prevLookActive)
+        {
+            if (prevLeftTriggerDown)
+                EndCommand(pushToTalkCommand);
+            if (prevRightTriggerDown)
+                EndCommand(cwsOrDisconnectAutopilotCommand);
+        }
+
+        // a trigger that drives an actuator in the current mode does not brake
+        if (leftTriggerDown && !compiledAxisBindings[mode][JOYSTICK_AXIS_ABSTRACT_LEFT_TRIGGER].handler)
+            leftBrakeRatio = EvaluateResponseCurve(&axisResponseCurves[JOYSTICK_AXIS_ABSTRACT_LEFT_TRIGGER], Normalize(leftTrigger, TRIGGER_THRESHOLD, 1.0f, 0.0f, 1.0f));
+        if (rightTriggerDown && !compiledAxisBindings[mode][JOYSTICK_AXIS_ABSTRACT_RIGHT_TRIGGER].handler)
+            rightBrakeRatio = EvaluateResponseCurve(&axisResponseCurves[JOYSTICK_AXIS_ABSTRACT_RIGHT_TRIGGER], Normalize(rightTrigger, TRIGGER_THRESHOLD, 1.0f, 0.0f, 1.0f));
+    }
+
+    SetDatafCached(leftBrakeRatioDataRef, leftBrakeRatio);
+    SetDatafCached(rightBrakeRatioDataRef, rightBrakeRatio);
+
+    prevLookActive = lookActive;
+    prevLeftTriggerDown = leftTriggerDown;
+    prevRightTriggerDown = rightTriggerDown;
+
+    return active;
+}
+
+static int UpdateWriteCache(XPLMDataRef dataRef, int index, int array, float value)
+{
+    // returns 1 if the value differs from the value the given dataref and index currently holds
+    const int cycleNumber = frameState.cycleNumber;
+    for (int i = 0; i < writeCacheSize; i++)
+    {
+        CachedWrite *cachedWrite = &writeCache[i];
+        if (cachedWrite->dataRef == dataRef && cachedWrite->index == index)
+        {
+            // the sim, the aircraft or other plugins may have written to the dataref since our last write in an earlier cycle, so only then we need to read it back
+            if (cachedWrite->cycleNumber != cycleNumber)
+            {
+                if (array)
+                    XPLMGetDatavf(dataRef, &cachedWrite->value, index, 1);
+                else
+                    cachedWrite->value = XPLMGetDataf(dataRef);
+                cachedWrite->cycleNumber = cycleNumber;
+            }
+
+            if (fabs(cachedWrite->value - value) < WRITE_CACHE_EPSILON)
+                return 0;
+
+            cachedWrite->value = value;
+            return 1;
+        }
+    }
+
+    if (writeCacheSize < WRITE_CACHE_SIZE)
+    {
+        CachedWrite cachedWrite = {dataRef, index, cycleNumber, value};
+        writeCache[writeCacheSize++] = cachedWrite;
+    }
+
+    return 1;
+}
+
+static void WakeFlightLoop(void)
+{
+    // while idling the input flight loop is scheduled with a longer interval, so we reschedule it to process new input during the next frame
+    if (inputFlightLoop && inputFlightLoopIdle)
+        XPLMScheduleFlightLoop(inputFlightLoop, -1.0f, 1);
+}
+
 inline static void WireKey(KeyboardKey *keyboardKey, KeyboardKey *left, KeyboardKey *right, KeyboardKey *above, KeyboardKey *below)
 {
     (*keyboardKey).left = left;